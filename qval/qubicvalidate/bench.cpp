@@ -0,0 +1,613 @@
+/***************************************************************************
+                          bench.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Main function of qubicbench, which times the board primitives and
+ * the forcing search.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "qval.h"
+#include "iso.h"
+#include "win.h"
+#include "board.h"
+#include "strategic.h"
+#include "timer.h"
+
+/// Times the primitives of class board, one at a time.
+
+/// Every primitive is run over the 2929 positions of the strategic
+/// dictionary, each already set up on a board of its own, so that nothing
+/// but the primitive is timed.  A batch runs through them enough times to
+/// take a while by the clock; the time per operation is averaged over a
+/// number of batches, with a 95% confidence interval.
+
+class benchmark {
+public:
+    benchmark();
+    ~benchmark();
+    /// Time one primitive, by name.
+    bool run(const char *name, std::ofstream &json);
+    /// Time them all.
+    void runall(std::ofstream &json);
+    /// Time the forcing search over a corpus of positions.
+    bool search(const char *corpus, std::ofstream &json);
+    /// List the names of the primitives.
+    static void list();
+    int batches;            ///< Number of batches to time.
+    long long minbatch;     ///< Least time for a batch, in nanoseconds.
+private:
+    /// A primitive, run \a reps times over all positions.
+    typedef long (benchmark::*work)(int reps);
+    /// A named primitive.
+    struct entry {
+        const char *name;   ///< What it's called on the command line.
+        work fn;            ///< The code to time.
+    };
+    static const entry entries[];
+
+    int count;              ///< Number of positions.
+    board *boards;          ///< One board for each position.
+    char (*patterns)[65];   ///< The canonical description of each position.
+    int *moveto;            ///< The strategic move of each position.
+    board scratch;          ///< A board for primitives that change the position.
+    long sink;              ///< Results, kept so the work isn't optimized away.
+
+    static double summarize(const double *x, int n, double &sd, double &ci, double &fastest);
+    void measure(const entry &e, std::ofstream &json);
+    long takes(int reps);
+    long gives(int reps);
+    long winners(int reps);
+    long forceds(int reps);
+    long canforces(int reps);
+    long canonicals(int reps);
+    long stdstrings(int reps);
+    long positions(int reps);
+    long movelists(int reps);
+    long strategics(int reps);
+};
+
+const benchmark::entry benchmark::entries[] = {
+    {"take",            &benchmark::takes},
+    {"give",            &benchmark::gives},
+    {"winner",          &benchmark::winners},
+    {"forced",          &benchmark::forceds},
+    {"canForceAt",      &benchmark::canforces},
+    {"canonical",       &benchmark::canonicals},
+    {"setstdstring",    &benchmark::stdstrings},
+    {"setposition",     &benchmark::positions},
+    {"setmovelist",     &benchmark::movelists},
+    {"strategicmove",   &benchmark::strategics},
+    {NULL,              NULL}
+};
+
+/// Two-sided 95% points of Student's t distribution, by degrees of freedom.
+static const double student95[31] = {
+    0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+//************************************************************************** benchmark()
+/**
+ * Set up a board for every position of the strategic dictionary.
+ */
+benchmark::benchmark() {
+    int st, i;
+
+    batches = 20;
+    minbatch = 20000000LL;
+    sink = 0;
+    count = 2929;
+    boards = new board[count];
+    patterns = new char[count][65];
+    moveto = new int[count];
+    for (st=0; st<count; st++) {
+        strategic &strat = strategic::find(st);
+        for (i=0; i<64; i++) {
+            switch (strat.points[i]) {
+            case point::X:
+                boards[st].take(i);
+                break;
+            case point::O:
+                boards[st].give(i);
+                break;
+            }
+        }
+        boards[st].setstdstring(patterns[st]);
+        moveto[st] = strat.moveto;
+    }
+}
+
+benchmark::~benchmark() {
+    delete[] boards;
+    delete[] patterns;
+    delete[] moveto;
+}
+
+//************************************************************************** list()
+/**
+ * Print the names of the primitives that can be timed.
+ */
+void
+benchmark::list() {
+    for (const entry *e=entries; e->name; e++) {
+        cout << " " << e->name;
+    }
+    cout << endl;
+}
+
+//************************************************************************** run(const char *, std::ofstream &)
+/**
+ * Time a primitive.
+ * \param name the name of the primitive.
+ * \param json where to write the result as a line of JSON, if it's open.
+ * \return false if there is no such primitive.
+ */
+bool
+benchmark::run(const char *name, std::ofstream &json) {
+    for (const entry *e=entries; e->name; e++) {
+        if (strcmp(e->name, name) == 0) {
+            measure(*e, json);
+            return true;
+        }
+    }
+    return false;
+}
+
+//************************************************************************** runall(std::ofstream &)
+/**
+ * Time every primitive.
+ * \param json where to write the results, if it's open.
+ */
+void
+benchmark::runall(std::ofstream &json) {
+    for (const entry *e=entries; e->name; e++) {
+        measure(*e, json);
+    }
+}
+
+//************************************************************************** summarize(const double *, int, double &, double &, double &)
+/**
+ * Sum up a set of timings.
+ * \param x the timings.
+ * \param n how many there are.
+ * \param sd (output) their standard deviation.
+ * \param ci (output) the half-width of the 95% confidence interval of the mean.
+ * \param fastest (output) the least of them.
+ * \return their mean.
+ */
+double
+benchmark::summarize(const double *x, int n, double &sd, double &ci, double &fastest) {
+    double mean = 0, var = 0;
+    int i;
+
+    fastest = x[0];
+    for (i=0; i<n; i++) {
+        mean += x[i];
+        if (x[i] < fastest) fastest = x[i];
+    }
+    mean /= n;
+    for (i=0; i<n; i++) {
+        var += (x[i] - mean) * (x[i] - mean);
+    }
+    sd = ci = 0;
+    if (n > 1) {
+        sd = sqrt(var / (n - 1));
+        ci = ((n - 1 <= 30) ? student95[n - 1] : 1.96) * sd / sqrt((double)n);
+    }
+    return mean;
+}
+
+//************************************************************************** measure(const entry &, std::ofstream &)
+/**
+ * Time a primitive, and report the time per operation.  The number of runs
+ * in a batch is doubled until a batch takes at least \a minbatch, and one
+ * batch is thrown away to warm up the caches.
+ * \param e the primitive.
+ * \param json where to write the result, if it's open.
+ */
+void
+benchmark::measure(const entry &e, std::ofstream &json) {
+    timer clock;
+    int reps, b;
+    double *ns = new double[batches];
+    double mean, sd, ci, fastest;
+
+    reps = 1;
+    for (;;) {
+        clock.reset();
+        sink += (this->*e.fn)(reps);
+        if (clock.elapsed() >= minbatch) break;
+        reps *= 2;
+    }
+    for (b=0; b<batches; b++) {
+        clock.reset();
+        sink += (this->*e.fn)(reps);
+        ns[b] = (double)clock.elapsed() / ((double)reps * count);
+    }
+
+    mean = summarize(ns, batches, sd, ci, fastest);
+    delete[] ns;
+
+    cout << setw(14) << e.name << fixed << setprecision(1)
+        << setw(12) << mean << " ns/op +/- " << setw(8) << ci
+        << "  (min " << fastest << ", " << (long long)reps * count << " ops/batch)" << endl;
+    if (json.is_open()) {
+        json << fixed << setprecision(2)
+            << "{\"bench\":\"" << e.name << "\""
+            << ",\"positions\":" << count
+            << ",\"ops\":" << (long long)reps * count
+            << ",\"batches\":" << batches
+            << ",\"ns_per_op\":" << mean
+            << ",\"stddev\":" << sd
+            << ",\"ci95\":" << ci
+            << ",\"min\":" << fastest << "}" << endl;
+    }
+}
+
+//************************************************************************** takes(int)
+/// The strategic move and its revocation, on each position.
+long
+benchmark::takes(int reps) {
+    for (int r=0; r<reps; r++) {
+        for (int i=0; i<count; i++) {
+            boards[i].take(moveto[i]);
+            boards[i].untake(moveto[i]);
+        }
+    }
+    return 0;
+}
+
+//************************************************************************** gives(int)
+/// An opponent move to the same point, and its revocation.
+long
+benchmark::gives(int reps) {
+    for (int r=0; r<reps; r++) {
+        for (int i=0; i<count; i++) {
+            boards[i].give(moveto[i]);
+            boards[i].untake(moveto[i]);
+        }
+    }
+    return 0;
+}
+
+//************************************************************************** winners(int)
+long
+benchmark::winners(int reps) {
+    long s = 0;
+    for (int r=0; r<reps; r++) {
+        for (int i=0; i<count; i++) {
+            s += boards[i].winner();
+        }
+    }
+    return s;
+}
+
+//************************************************************************** forceds(int)
+long
+benchmark::forceds(int reps) {
+    long s = 0;
+    for (int r=0; r<reps; r++) {
+        for (int i=0; i<count; i++) {
+            s += boards[i].forced();
+        }
+    }
+    return s;
+}
+
+//************************************************************************** canforces(int)
+long
+benchmark::canforces(int reps) {
+    int targets[65];
+    long s = 0;
+    for (int r=0; r<reps; r++) {
+        for (int i=0; i<count; i++) {
+            s += boards[i].status.canForceAt(targets);
+        }
+    }
+    return s;
+}
+
+//************************************************************************** canonicals(int)
+long
+benchmark::canonicals(int reps) {
+    long s = 0;
+    for (int r=0; r<reps; r++) {
+        for (int i=0; i<count; i++) {
+            s += boards[i].canonical()->val(0);
+        }
+    }
+    return s;
+}
+
+//************************************************************************** stdstrings(int)
+long
+benchmark::stdstrings(int reps) {
+    char canonic[65];
+    long s = 0;
+    for (int r=0; r<reps; r++) {
+        for (int i=0; i<count; i++) {
+            boards[i].setstdstring(canonic);
+            s += canonic[0];
+        }
+    }
+    return s;
+}
+
+//************************************************************************** positions(int)
+/// Setting up each position from its description.
+long
+benchmark::positions(int reps) {
+    long s = 0;
+    for (int r=0; r<reps; r++) {
+        for (int i=0; i<count; i++) {
+            scratch.setposition(patterns[i]);
+            s += scratch.val(0);
+        }
+    }
+    return s;
+}
+
+//************************************************************************** movelists(int)
+/// Finding the moves equivalent to the strategic move, as phase 1 does.
+long
+benchmark::movelists(int reps) {
+    int list[192], n;
+    long s = 0;
+    for (int r=0; r<reps; r++) {
+        for (int i=0; i<count; i++) {
+            boards[i].setmovelist(moveto[i], list, n, &iso::isos[0]);
+            s += n;
+        }
+    }
+    return s;
+}
+
+//************************************************************************** strategics(int)
+long
+benchmark::strategics(int reps) {
+    long s = 0;
+    for (int r=0; r<reps; r++) {
+        for (int i=0; i<count; i++) {
+            s += boards[i].strategicmove();
+        }
+    }
+    return s;
+}
+
+//************************************************************************** search(const char *, std::ofstream &)
+/**
+ * Time board::sequence() on each position of a corpus, as phase 3 runs it.
+ * Each line of the corpus is a grade and a position description; blank
+ * lines and lines starting with '#' are skipped.  Every position is searched
+ * \a batches times.  The search output goes to /dev/null, so the cost of
+ * writing it is counted.  Totals are given for each grade, and overall.
+ * \param corpus the name of the corpus file.
+ * \param json where to write the results, if it's open.
+ * \return false if the corpus can't be read.
+ */
+bool
+benchmark::search(const char *corpus, std::ofstream &json) {
+    const int maxgrades = 16;
+    std::ifstream in;
+    char text[100], grade[20], pos[65];
+    char grades[maxgrades][20];
+    int ngrades = 0, g, r, move, nodes;
+    double positions[maxgrades + 1], totalnodes[maxgrades + 1], totalns[maxgrades + 1];
+    double failed[maxgrades + 1];
+    double *ns = new double[batches];
+    double *first = new double[batches];
+    double mean, sd, ci, fastest, tofirst;
+    timer clock;
+
+    in.open(corpus, ios::in);
+    if (!in.is_open()) {
+        delete[] ns;
+        delete[] first;
+        return false;
+    }
+    tree.open("/dev/null", ios::out);
+    for (g=0; g<=maxgrades; g++) {
+        positions[g] = totalnodes[g] = totalns[g] = failed[g] = 0;
+    }
+
+    while (in.getline(text, sizeof(text))) {
+        if (text[0] == '\0' || text[0] == '#') continue;
+        if (sscanf(text, "%19s %64s", grade, pos) != 2) {
+            cerr << "Bad corpus line: " << text << endl;
+            continue;
+        }
+        for (g=0; g<ngrades && strcmp(grades[g], grade); g++) ;
+        if (g == ngrades) {
+            if (ngrades == maxgrades) {
+                cerr << "Too many grades in " << corpus << endl;
+                continue;
+            }
+            strcpy(grades[ngrades++], grade);
+        }
+
+        move = -1;
+        nodes = 0;
+        for (r=0; r<batches; r++) {
+            scratch.setposition(pos);
+            long long started = timer::now();
+            move = scratch.sequence(false);
+            ns[r] = (double)(timer::now() - started);
+            first[r] = (move >= 0) ? (double)(scratch.proved - started) : 0;
+            nodes = scratch.seqboards;
+        }
+        tofirst = summarize(first, batches, sd, ci, fastest);
+        mean = summarize(ns, batches, sd, ci, fastest);
+
+        positions[g]++;
+        totalnodes[g] += nodes;
+        totalns[g] += mean;
+        if (move < 0) failed[g]++;
+
+        cout << setw(8) << grade << ' ' << setw(30) << pos << fixed << setprecision(3)
+            << setw(10) << mean / 1e6 << " ms +/- " << setw(7) << ci / 1e6
+            << setw(10) << nodes << " nodes" << setprecision(0)
+            << setw(10) << nodes / (mean / 1e9) << " nodes/s"
+            << "  depth " << scratch.seqdepth << endl;
+        if (json.is_open()) {
+            json << fixed << setprecision(0)
+                << "{\"search\":\"" << pos << "\""
+                << ",\"grade\":\"" << grade << "\""
+                << ",\"runs\":" << batches
+                << ",\"move\":" << move
+                << ",\"depth\":" << scratch.seqdepth
+                << ",\"nodes\":" << nodes
+                << ",\"ns\":" << mean
+                << ",\"ci95\":" << ci
+                << ",\"min\":" << fastest
+                << ",\"first_proof_ns\":" << tofirst
+                << ",\"nodes_per_sec\":" << nodes / (mean / 1e9) << "}" << endl;
+        }
+    }
+    in.close();
+    tree.close();
+    delete[] ns;
+    delete[] first;
+
+    // The totals: one for each grade, and then all of them together.
+    for (g=0; g<ngrades; g++) {
+        positions[maxgrades] += positions[g];
+        totalnodes[maxgrades] += totalnodes[g];
+        totalns[maxgrades] += totalns[g];
+        failed[maxgrades] += failed[g];
+    }
+    for (g=0; g<=ngrades; g++) {
+        int k = (g < ngrades) ? g : maxgrades;
+        const char *name = (g < ngrades) ? grades[g] : "total";
+        if (positions[k] == 0) continue;
+        cout << setw(8) << name << ": " << setprecision(0) << positions[k] << " positions, "
+            << totalnodes[k] << " nodes in " << setprecision(3) << totalns[k] / 1e9 << " s, "
+            << setprecision(0) << totalnodes[k] / (totalns[k] / 1e9) << " nodes/s, "
+            << failed[k] << " unproven" << endl;
+        if (json.is_open()) {
+            json << fixed << setprecision(0)
+                << "{\"search\":\"" << name << "\""
+                << ",\"positions\":" << positions[k]
+                << ",\"nodes\":" << totalnodes[k]
+                << ",\"ns\":" << totalns[k]
+                << ",\"nodes_per_sec\":" << totalnodes[k] / (totalns[k] / 1e9)
+                << ",\"unproven\":" << failed[k] << "}" << endl;
+        }
+    }
+    return true;
+}
+
+//************************************************************************** usage(char *)
+static void
+usage(char *me) {
+    cout << "usage: " << me << " [-b<batches>] [-m<ms>] [-o<jsonfile>] [-s[corpus]] [primitive...]"
+        << endl;
+    cout << "       -b: time this many batches of each (default 20, or 3 with -s)" << endl;
+    cout << "       -m: make each batch last at least this long (default 20)" << endl;
+    cout << "       -o: write results as JSON lines to <jsonfile> (default bench.json)" << endl;
+    cout << "       -s: time the forcing search on <corpus> (default searchcorpus.txt)" << endl;
+    cout << "       primitives:";
+    benchmark::list();
+}
+
+//************************************************************************** main(int, char **)
+/**
+ * Usage:
+ *     qubicbench [-b<batches>] [-m<ms>] [-o<jsonfile>] [-s[corpus]] [primitive...]
+ *
+ * Times the named primitives, or all of them, or else the search.
+ */
+int main(int argc, char *argv[])
+{
+    int argn, first;
+    int batches = 0;
+    long ms = 20;
+    const char *jsonfile = "bench.json";
+    const char *corpus = NULL;
+    char *endptr;
+    std::ofstream json;
+
+    for (argn=1; argn<argc; argn++) {
+        if (*argv[argn] != '-') break;
+        switch (argv[argn][1]) {
+        case 'b':
+                    batches = strtol(&argv[argn][2], &endptr, 10);
+                    if (*endptr || batches < 1) {
+                        cerr << "Bad -b switch" << endl;
+                        usage(argv[0]);
+                        exit(1);
+                    }
+                    break;
+        case 'm':
+                    ms = strtol(&argv[argn][2], &endptr, 10);
+                    if (*endptr || ms < 1) {
+                        cerr << "Bad -m switch" << endl;
+                        usage(argv[0]);
+                        exit(1);
+                    }
+                    break;
+        case 'o':
+                    jsonfile = &argv[argn][2];
+                    break;
+        case 's':
+                    corpus = argv[argn][2] ? &argv[argn][2] : "searchcorpus.txt";
+                    break;
+        default:
+                    cerr << "Unknown argument: " << argv[argn] << endl;
+                    usage(argv[0]);
+                    exit(1);
+        }
+    }
+    first = argn;
+
+    deterministic = true;           // the same work every time
+    iso::init();
+    win::init();
+    strategic::init();
+
+    benchmark bench;
+    bench.batches = batches ? batches : (corpus ? 3 : 20);
+    bench.minbatch = ms * 1000000LL;
+    if (*jsonfile) json.open(jsonfile, ios::out);
+
+    if (corpus) {
+        if (!bench.search(corpus, json)) {
+            cerr << "Cannot read " << corpus << endl;
+            exit(1);
+        }
+    } else if (first == argc) {
+        bench.runall(json);
+    } else {
+        for (argn=first; argn<argc; argn++) {
+            if (!bench.run(argv[argn], json)) {
+                cerr << "Unknown primitive: " << argv[argn] << endl;
+                usage(argv[0]);
+                exit(1);
+            }
+        }
+    }
+    json.close();
+    return EXIT_SUCCESS;
+}
@@ -26,6 +26,13 @@
 #include "board.h"
 #include "point.h"
 #include "line.h"
+#include "solcache.h"
+#include "playbook.h"
+#include "originstats.h"
+#include "dependencies.h"
+#include "timer.h"
+#include "phasereport.h"
+#include "perfcounters.h"
 
 //****************************************************************** init()
 /**
@@ -35,8 +42,17 @@
  */
 void
 board::init() {
+    trace = NULL;
+    account = &report;
+    origin = -1;
+    entry = -1;
     seqlevel = 0;
     seqboards = 0;
+    seqdepth = 0;
+    proved = 0;
+    deadline = 0;
+    timedout = false;
+    halt = NULL;
     plays = 0;
     forcing = 0;
     // points are auto-initialized (I hope)
@@ -115,12 +131,22 @@ board::show(const iso &v) {
 //****************************************************************** canonical()
 /**
  * Returns a pointer to an isomorphism under which this board is in canonical
- * form.  This may not be unique, in which case a random choice is made.
+ * form.  This may not be unique, in which case a random choice is made.  In
+ * deterministic mode the choice is always the lowest-numbered isomorphism, so
+ * a given position maps the same way every time it is seen.
  * \return A pointer to an isomorphism under which this board is in canonical form.
  */
 iso *
 board::canonical() {
     int i, s, candidate[198], it;
+    // Only one call in SAMPLE is timed; the clock costs too much to read twice
+    // on every call.
+    bool timed = (++account->canonicals % phasereport::SAMPLE) == 0;
+    long long started = timed ? timer::now() : 0;
+    stats.canonicals++;
+#ifdef PERFCOUNTERS
+    perfcounters::begin(perfcounters::CANONICAL);
+#endif
     candidate[0] = s = 0;
     i=1;
     for (int j=1; j<iso::nextiso; j++) {
@@ -152,7 +178,7 @@ board::canonical() {
     cout << "There are " << i << " canonical forms" << endl;
 #endif
     if (i>1) {
-        it = random() % i;
+        it = qubicRandom() % i;
 #ifndef NDEBUG
         cout << "Picking number " << it << endl;
 #endif
@@ -162,6 +188,10 @@ board::canonical() {
 #ifndef NDEBUG
     cout << "Canonical form:" << endl;
     show(iso::isos[candidate[it]]);
+#endif
+    if (timed) account->canonns += phasereport::SAMPLE * (timer::now() - started);
+#ifdef PERFCOUNTERS
+    perfcounters::end(perfcounters::CANONICAL);
 #endif
     return &iso::isos[candidate[it]];
 }
@@ -169,32 +199,34 @@ board::canonical() {
 //********************************************************** strategicmove()
 /**
  * Determines if there is a strategic move for the current position (if any).
+ * The canonical form of the position is looked up in the strategic index.
  * \return a strategic move if there is one; otherwise returns -1.
  */
 int
 board::strategicmove() {
     int i;
-    iso *stdForm = canonical();
+    iso *stdForm;
+    poskey key;
 
-    for (i=0; i<strategic::i; i++) {
-        bool okay=true;
-        for (int k=0; k<64; k++) {
-            if (strategic::smv[i].points[k] != points[stdForm->index[k]].val()) {
-                okay = false;
-                break;
-            }
-        }
-        if (okay) {
-            int res =stdForm->index[strategic::smv[i].moveto];
+#ifdef PERFCOUNTERS
+    perfcounters::begin(perfcounters::STRATEGIC);
+#endif
+    setkey(key, &stdForm);
+    i = strategic::lookup(key);
+    entry = i;
+#ifdef PERFCOUNTERS
+    perfcounters::end(perfcounters::STRATEGIC);
+#endif
+    if (i >= 0) {
+        int res =stdForm->index[strategic::smv[i].moveto];
 #ifndef NDEBUG
-            cout << "Strategic move (canonic) for " << strategic::smv[i].pattern
-                    << " is " << strategic::smv[i].moveto << endl;
-            cout << "Stragegic move (board) is " << res << endl;
-            cout << "Using this iso:" << endl;
-            stdForm->show();
+        cout << "Strategic move (canonic) for " << strategic::smv[i].pattern
+                << " is " << strategic::smv[i].moveto << endl;
+        cout << "Stragegic move (board) is " << res << endl;
+        cout << "Using this iso:" << endl;
+        stdForm->show();
 #endif
-            return res;
-        }
+        return res;
     }
 #ifndef NDEBUG
     cout << "Must be a forced win somewhere" << endl;
@@ -202,6 +234,58 @@ board::strategicmove() {
     return -1;
 }
 
+//********************************************************** bookmove()
+/**
+ * Looks the canonical form of the position up in the compiled playbook, if
+ * one is open.
+ * \return the playbook's move if it has one; otherwise returns -1.
+ */
+int
+board::bookmove() {
+    iso *stdForm;
+    poskey key;
+    int m;
+
+    if (!book) return -1;
+    setkey(key, &stdForm);
+    m = book->find(key);
+    return (m >= 0) ? stdForm->val(m) : -1;
+}
+
+//********************************************************** dictionarymove()
+/**
+ * Determines if the current position is one of the strategic ones, as
+ * strategicmove() does, but first asks the strategic filter whether that's
+ * possible, so that most positions are turned away cheaply.  A position that
+ * is found is noted as reached.
+ * \return a strategic move if there is one; otherwise returns -1.
+ */
+int
+board::dictionarymove() {
+    int m;
+
+    if (forced() >= 0) return -1;
+    if (!strategic::maybe(census())) return -1;
+    m = strategicmove();
+    if (m >= 0 && reachedstrategic.is_open()) outboard(reachedstrategic);
+    return m;
+}
+
+//****************************************************************** census()
+/**
+ * Sums up the states of all the lines.  Any two isomorphic positions have
+ * the same census, so it's a quick first test for finding a position.
+ * \return the census.
+ */
+unsigned long long
+board::census() {
+    unsigned long long c = 0;
+    for (int i=0; i<76; i++) {
+        c += strategic::linemix(lines[i].Xcount(), lines[i].Ocount());
+    }
+    return c;
+}
+
 //****************************************************************** winner()
 /**
  * Determines if there is a winning move.
@@ -243,21 +327,53 @@ int
 board::sequence(bool verbose) {
     bound bnd;
     int rem;
+    poskey mykey;
+    iso *myiso;
     
+#ifdef PERFCOUNTERS
+    perfcounters::begin(perfcounters::SEQUENCE);
+#endif
     forcing = plays;
     seqlevel = 0;                    // initialize debugging stuff
     seqboards = 0;
+    seqdepth = 0;
+    proved = 0;
+    timedout = false;
     haveSolution = false;
+    stats.clear();
+    if (depends) depends->clear();
+
+    // Maybe this was settled by an earlier run.
+    if (solutions) {
+        solcache::solution known;
+        setkey(mykey, &myiso);
+        // A failure is not final if the dictionary was not used to find it
+        // but can be used now.
+        if (solutions->find(mykey, known)
+                && (known.move >= 0 || !strategicleaf || (known.flags & solcache::LEAVES))) {
+            forcing = 0;
+            stats.cached = true;
+            int m = cached(known, myiso, verbose);
+#ifdef PERFCOUNTERS
+            perfcounters::end(perfcounters::SEQUENCE);
+#endif
+            return m;
+        }
+    }
     
     // Try first with a small bound.  That is, try for a quick win.
-    bnd = sequence(plays+12);
+    bnd = pass(plays+12);
     // If that fails, try next with a modest bound.  That is, try harder.
-    if (bnd.where<0 && plays + 12 < 65) {
-        bnd=sequence(plays+24);
+    if (bnd.where<0 && !timedout && plays + 12 < 65) {
+        bnd = pass(plays+24);
     }
     // If that still doesn't work, try real hard by allowing any winning sequence.
-    if (bnd.where<0 && plays + 24 < 65) {
-        bnd=sequence(65);
+    if (bnd.where<0 && !timedout && plays + 24 < 65) {
+        bnd = pass(65);
+    }
+    if (bnd.where>=0) {
+        seqdepth = bnd.depth - plays;
+        if (!proved) proved = timer::now();
     }
     if (bnd.where>=0 && verbose) {
         rem = (bnd.depth-plays)/2;
@@ -269,10 +385,135 @@ board::sequence(bool verbose) {
                 << endl;
         }
     }
+    // Remember this for next time.  Failures are worth remembering too: the
+    // last pass was not limited, so there really is no forced win.  A search
+    // cut short by the clock has proven nothing.
+    if (solutions && !timedout) {
+        solutions->store(mykey, (bnd.where>=0) ? myiso->inverse()->val(bnd.where) : -1,
+                (bnd.where>=0) ? bnd.depth-plays : 0, seqboards,
+                strategicleaf ? solcache::LEAVES : 0);
+        if (depends && bnd.where >= 0) depends->record(mykey);
+    }
     forcing = 0;
+#ifdef PERFCOUNTERS
+    perfcounters::end(perfcounters::SEQUENCE);
+#endif
     return bnd.where;
 }
 
+//********************************************************** sequence(bool, long long, bool &)
+/**
+ * \overload
+ * Finds a forcing sequence as sequence(bool) does, but gives up at a
+ * deadline.  The clock is read every CLOCKEVERY boards, so the search stops
+ * soon after.  Since the search stops at the first winning move it proves,
+ * a move it has found is as good as any it could find later.  Failing that,
+ * the best-looking move is taken instead.
+ * \param verbose whether to output bragging messages.
+ * \param until when to give up, by timer::now(); 0 for never.
+ * \param proven (output) whether the move begins a forced win; if not, it
+ * is only the one heuristic() likes best.
+ * \return the move, or -1 if the board is full.
+ */
+int
+board::sequence(bool verbose, long long until, bool &proven) {
+    int m;
+
+    deadline = until;
+    m = sequence(verbose);
+    deadline = 0;
+    proven = m >= 0;
+    if (!proven) {
+        if (verbose && timedout) {
+            cout << "Out of time after " << seqboards << " positions; I'll play my hunch."
+                << endl;
+        }
+        m = heuristic();
+    }
+    return m;
+}
+
+//********************************************************** heuristic()
+/**
+ * Picks a move without searching: the empty point with the best score, by
+ * the lines through it that the opponent has not blocked and how far along
+ * they are.  Ties go to the lowest point.
+ * \return the move, or -1 if the board is full.
+ */
+int
+board::heuristic() {
+    int i, s, best = -1, bestscore = -1;
+
+    for (i=0; i<64; i++) {
+        if (!points[i].is_empty()) continue;
+        s = points[i].score();
+        if (s > bestscore) {
+            best = i;
+            bestscore = s;
+        }
+    }
+    return best;
+}
+
+//********************************************************** cached(solution &, iso *, bool)
+/**
+ * Use a result of sequence() found in the solution cache.  Only the first
+ * move of a win is recorded in the tree; the rest was recorded by the run
+ * that proved it.
+ * \param known what the cache says about this position.
+ * \param myiso the canonical isomorphism of the position it was found with.
+ * \param verbose whether to output bragging messages.
+ * \return a move that begins a winning forced sequence if any, otherwise -1.
+ */
+int
+board::cached(const solcache::solution &known, iso *myiso, bool verbose) {
+    char mycanonic[65];
+    char resultcanonic[65];
+    int where;
+
+    seqboards = 0;
+    if (known.move < 0) return -1;
+    seqdepth = known.depth;
+    proved = timer::now();
+    where = myiso->val(known.move);
+    if (verbose) {
+        if (known.depth < 4) {
+            cout << "I will win next turn" << endl;
+        } else {
+            cout << "I will win in " << known.depth/2 << " plays" << endl;
+            cout << "I knew this one already." << endl;
+        }
+    }
+    setstdstring(mycanonic);
+    take(where);
+    setstdstring(resultcanonic);
+    outtree(mycanonic, known.move, resultcanonic, 'c');
+    untake(where);
+    return where;
+}
+
+//********************************************************** pass(int)
+/**
+ * One pass of the search, under a limit on the sequence length.  The time
+ * it takes is recorded in the statistics.  In the report, the time spent
+ * meanwhile making canonical forms and writing the tree is left to those,
+ * so that no time is counted twice.
+ * \param blim a bound limit.
+ * \return a bound object representing a move and a length.
+ */
+board::bound
+board::pass(int blim) {
+    long long nested = account->canonns + account->ions;
+    long long started = timer::now();
+    bound bnd = sequence(blim);
+    long long took = timer::now() - started;
+    if (stats.passes < searchstats::MAXPASS) {
+        stats.passns[stats.passes++] = took;
+    }
+    account->searchns += took - (account->canonns + account->ions - nested);
+    return bnd;
+}
+
 //********************************************************** sequence(int)
 /** 
  * \overload
@@ -287,15 +528,17 @@ board::sequence(bool verbose) {
  * When trimming removes one or more plays from the sequence, this current
  * level will be deeper than the new pruning bound.  This is reported as a
  * failure, but with a shorter bound.  Generally, this will cause quick exit
- * from over-deep search levels.
+ * from over-deep search levels.  Trimming is left out when NOTRIM is defined,
+ * as it is by default.
  * \param blim a bound limit.
  * \return a bound object representing a move and a length.
  */
 board::bound
 board::sequence(int blim) {
-    int targets[64], winners[64], scores[64];
+    int targets[64], winners[64], scores[64], setups[64];
     int i,m,f,w;
-    int  forces;
+    int  forces, forks;
+    winset twos, ones, otwos;
     bound bnd,res;
     int currdepth = blim;
 
@@ -307,10 +550,19 @@ board::sequence(int blim) {
     w=0;
     bnd.where = -1;
     bnd.depth = currdepth;
+    ++seqboards;
+    // Out of time: fail, without changing the bound, all the way back up.
+    if (timedout || (deadline && seqboards % CLOCKEVERY == 0
+            && (timer::now() >= deadline || (halt && *halt)))) {
+        timedout = true;
+        return bnd;
+    }
 #ifndef QUBICVALIDATE
-    if ((++seqboards) % 50000 == 0) {cout << "."; cout.flush();};
+    if (seqboards % 50000 == 0) {cout << "."; cout.flush();};
 #endif
     seqlevel++;
+    stats.node(seqlevel);
+    note(searchtrace::ENTER, -1);
 #ifndef NDEBUG
     if (haveSolution && (seqboards > 50000)) return bnd;
     cout << setw(seqlevel*2) << "" << "Considering my move on this board:" << endl;
@@ -320,6 +572,8 @@ board::sequence(int blim) {
 #ifndef NDEBUG
         cout << setw(seqlevel*2) << "" << "Leaving because of depth bound " << endl;
 #endif
+        stats.cutoffs++;
+        note(searchtrace::CUTOFF, -1);
         seqlevel--;
         return bnd;
     }
@@ -332,6 +586,7 @@ board::sequence(int blim) {
             << external(m) << endl;
 #endif
         bnd.where = m;
+        note(searchtrace::PROOF, m);
 
 #ifdef NOTRIM
         bnd.depth = plays;
@@ -339,6 +594,15 @@ board::sequence(int blim) {
         bnd.depth = trim();
 #endif
 
+    } else if (strategicleaf && seqlevel > 1 && (m = dictionarymove()) >= 0) {
+        // A strategic position: the dictionary covers the rest of the way.
+        if (depends) depends->use(entry);
+#ifndef NDEBUG
+        cout << setw(seqlevel*2) << "" << "This is a strategic position; move to "
+            << external(m) << endl;
+#endif
+        bnd.where = m;
+        bnd.depth = plays;
     } else {
         // If not, am I forced?
         setstdstring(mycanonic, &myiso);
@@ -346,6 +610,7 @@ board::sequence(int blim) {
         bnd.where = -1;
         if (m>=0) {
             // The only possibility is if the forced move is itself forcing
+            note(searchtrace::FORCE, m);
             take(m);
             f = forced();    // Am I still forced?  If so, I just lost.
             if (f<0) {
@@ -388,6 +653,7 @@ board::sequence(int blim) {
 
             // Step 1: find the forcing moves.
             forces = status.canForceAt(targets);
+            stats.forcing += forces;
 #ifndef NDEBUG
             cout << "I can force at:";
             for (i=0; i<forces; i++) {
@@ -396,9 +662,32 @@ board::sequence(int blim) {
             cout << endl;
 #endif
 
-            // Step 2: score the moves
+            // Step 1a: look for forks.  A move on two of my lines that have two
+            //   points each wins right after the reply.  Nothing else can be as
+            //   quick, so if there are any, they are the only ones to try.
+            twos = status.xtwos();
+            forks = 0;
+            for (i=0; i<forces; i++) {
+                if ((twos & win::at(targets[i])).count() >= 2) {
+                    targets[forks++] = targets[i];
+                }
+            }
+            if (forks) {
+#ifndef NDEBUG
+                cout << setw(seqlevel*2) << "" << "There are " << forks << " forks" << endl;
+#endif
+                forces = forks;
+            } else {
+                ones = status.xones();
+                otwos = status.otwos();
+            }
+
+            // Step 2: score the moves.  A move that sets up a fork for after the
+            //   reply comes first, and is settled here rather than a level down.
             for (i=0; i<forces; i++) {
                 scores[i] = points[targets[i]].score();
+                setups[i] = forks ? -1 : forksetup(targets[i], twos, ones, otwos);
+                if (setups[i] >= 0) scores[i] += 1 << 20;
             }
 
             // Step 3: take each in turn, in order by score.  This is done by selection
@@ -413,15 +702,18 @@ board::sequence(int blim) {
                 if (kmax != i) {
                     k = targets[i];  targets[i] = targets[kmax]; targets[kmax] = k;
                     k = scores[i];   scores[i]  = scores[kmax];  scores[kmax] = k;
+                    k = setups[i];   setups[i]  = setups[kmax];  setups[kmax] = k;
                 }
 
                 // now try the winner.
+                note(searchtrace::FORCE, targets[i]);
                 take(targets[i]);
 #ifndef NDEBUG
                     cout << setw(seqlevel*2) << "" << "Considering the move to "
                         << external(targets[i]) << endl;
 #endif
-                res = willwin(currdepth);
+                res = forks ? forkwin(currdepth)
+                    : setups[i] >= 0 ? setupwin(currdepth, setups[i]) : willwin(currdepth);
                 if (res.depth < currdepth) {
                     currdepth = res.depth;
                     w = 0;
@@ -432,6 +724,8 @@ board::sequence(int blim) {
                         << " wins after " << res.depth << " moves" << endl;
 #endif
                     winners[w++] = targets[i];
+                    note(searchtrace::PROOF, targets[i]);
+                    if (seqlevel == 1 && !proved) proved = timer::now();
                 }
                 untake(targets[i]);
 
@@ -439,6 +733,7 @@ board::sequence(int blim) {
                 // For validation, one winner is enough
                 if (w) break;
 #endif
+                if (timedout) break;
 
                 if (plays >= currdepth) {
 #ifndef NDEBUG
@@ -449,6 +744,8 @@ board::sequence(int blim) {
                         cout << "Finding a really short winning sequence..." << endl;
                     }
 #endif
+                    stats.cutoffs++;
+                    note(searchtrace::CUTOFF, -1);
                     seqlevel--;
                     bnd.where = -1;
                     bnd.depth = currdepth;
@@ -469,7 +766,7 @@ board::sequence(int blim) {
                     cout << setw(seqlevel*2) << "" << "Picking from among " << w
                         << " winning moves" << endl;
 #endif
-                    bnd.where = winners[random()%w];
+                    bnd.where = winners[qubicRandom()%w];
                 } else {
 #ifndef NDEBUG
                     cout << setw(seqlevel*2) << "" << "Just one winner among these" << endl;
@@ -515,6 +812,8 @@ board::willwin(int blim) {
     setstdstring(mycanonic, &myiso);
     m = winner();            // where opponent must block
     give(m);
+    stats.replies++;
+    note(searchtrace::REPLY, m);
     bnd = sequence(blim);        // can I still win?
     if (bnd.where>=0) {
         setstdstring(resultcanonic, &resultiso);
@@ -524,120 +823,208 @@ board::willwin(int blim) {
     return bnd;
 }
 
+//****************************************************************** forkwin()
+/**
+ * Does what willwin() does, for a move that has just made two threats.  The
+ * opponent can block only one of them, so the search need not go on to see
+ * that I win.
+ * \param blim the limit on the sequence length.
+ * \return a bound on the reply.
+ */
+board::bound
+board::forkwin(int blim) {
+    int m;
+    bound bnd;
+    char mycanonic[65];
+    iso *myiso;
+    char resultcanonic[65];
+    iso *resultiso;
+
+    Assert<bad_arg>(NASSERT || status.canwin());
+    setstdstring(mycanonic, &myiso);
+    m = winner();            // where opponent must block
+    give(m);
+    stats.replies++;
+    note(searchtrace::REPLY, m);
+    bnd.where = -1;
+    bnd.depth = blim;
+    if (plays < blim) {
+        bnd.where = winner();       // the threat that's left
+        Assert<bad_result>(NASSERT || bnd.where >= 0);
+        note(searchtrace::FORK, bnd.where);
+#ifdef NOTRIM
+        bnd.depth = plays;
+#else
+        bnd.depth = trim();
+#endif
+        setstdstring(resultcanonic, &resultiso);
+        outtree(mycanonic, myiso->inverse()->val(m), resultcanonic, 'b');
+    }
+    untake(m);
+    return bnd;
+}
+
+//****************************************************************** setupwin()
+/**
+ * Does what willwin() does, for a move that sets up a fork for after the
+ * reply (see forksetup()).  The reply, the fork, and the block of one of its
+ * threats are played here and recorded as sequence() and forkwin() would,
+ * without a level of search for the fork.
+ * \param blim the limit on the sequence length.
+ * \param fork where the fork is.
+ * \return a bound on the reply.
+ */
+board::bound
+board::setupwin(int blim, int fork) {
+    int m, f;
+    bound bnd;
+    char mycanonic[65];
+    iso *myiso;
+    char replycanonic[65];
+    iso *replyiso;
+    char forkcanonic[65];
+    iso *forkiso;
+    char resultcanonic[65];
+    iso *resultiso;
+
+    Assert<bad_arg>(NASSERT || status.canwin());
+    setstdstring(mycanonic, &myiso);
+    m = winner();            // where opponent must block
+    give(m);
+    stats.replies++;
+    note(searchtrace::REPLY, m);
+    bnd.where = -1;
+    bnd.depth = blim;
+    // The fork and the block make two more plays, and the win must come after.
+    if (plays + 2 < blim) {
+#ifndef NDEBUG
+        cout << setw(seqlevel*2) << "" << "The reply at " << external(m)
+            << " leaves a fork at " << external(fork) << endl;
+#endif
+        setstdstring(replycanonic, &replyiso);
+        note(searchtrace::FORCE, fork);
+        take(fork);
+        setstdstring(forkcanonic, &forkiso);
+        f = winner();        // the threat the opponent blocks
+        give(f);
+        stats.replies++;
+        note(searchtrace::REPLY, f);
+        Assert<bad_result>(NASSERT || winner() >= 0);
+        note(searchtrace::FORK, winner());
+        bnd.where = fork;
+#ifdef NOTRIM
+        bnd.depth = plays;
+#else
+        bnd.depth = trim();
+#endif
+        setstdstring(resultcanonic, &resultiso);
+        outtree(forkcanonic, forkiso->inverse()->val(f), resultcanonic, 'b');
+        untake(f);
+        outtree(replycanonic, replyiso->inverse()->val(fork), forkcanonic, 'c');
+        untake(fork);
+        outtree(mycanonic, myiso->inverse()->val(m), replycanonic, 'b');
+    }
+    untake(m);
+    return bnd;
+}
+
+//****************************************************************** forksetup()
+/**
+ * Tests whether a forcing move sets up a fork for my next move.  The move
+ * must make just one threat, the forced reply must not make a threat of its
+ * own, and afterward there must be an empty point on two of my lines with two
+ * points each, at least one of them new.  This needs only the tables of how
+ * lines cross, not any moves.
+ * \param where the forcing move.
+ * \param twos the lines where I now have two points.
+ * \param ones the lines where I now have one point.
+ * \param otwos the lines where the opponent now has two points.
+ * \return where the fork is, or -1 if there's none.
+ */
+int
+board::forksetup(int where, const winset &twos, const winset &ones, const winset &otwos) {
+    winset mine = twos & win::at(where);
+    int l, reply, k, n, c;
+
+    if (mine.count() != 1) return -1;
+    l = mine.first();
+    reply = -1;
+    for (k=0; k<4; k++) {
+        c = win::find(l).val(k);
+        if (c != where && isempty(c)) reply = c;
+    }
+    if (reply < 0 || !(otwos & win::at(reply)).empty()) return -1;
+
+    winset fresh = (ones & win::at(where)) - win::at(reply);
+    winset after = ((twos - mine) | fresh) - win::at(reply);
+    while (!fresh.empty()) {
+        n = fresh.first();
+        fresh.drop(n);
+        winset others = after;
+        others.drop(n);
+        while (!others.empty()) {
+            l = others.first();
+            others.drop(l);
+            c = win::meet(n, l);
+            if (c >= 0 && c != where && c != reply && isempty(c)) return c;
+        }
+    }
+    return -1;
+}
+
 //****************************************************************** trim()
 /**
  * Trims the current sequence, starting at the first forcing move. Moves not
  * required for the force are removed, starting at the end.  The resulting
  * pruning depth is reported.
+ *
+ * Nothing is replayed.  Each of my moves in the sequence made a threat along
+ * the line it shares with the reply that blocked it, and that threat needed
+ * the other two of my points on the line.  Working back from the win, a move
+ * is kept if the win or a threat that is kept runs through it.  To be safe,
+ * it is also kept if removing it would leave the opponent a threat, or if
+ * removing its reply would give me an extra one, because either could change
+ * what is forced along the way.
  * \return the pruning depth.
  */
 int
 board::trim() {
-    movenum trimmed[64], original[64];
-    bool okay;
-    int i,j,k,m;
-    int oplays = plays;
-    int trimlim = plays;
-    
+    bool needed[76];        // lines the win depends on
+    int i, k, l, t;
+    int kept = 0;
+
 #ifndef NDEBUG
     cout << "Trimming from " << forcing << " to " << plays << endl;
 #endif
-    
-    for (i=0; i<plays; i++) {
-        original[i] = trimmed[i] = moves[i];
-    }
+
+    for (l=0; l<76; l++) needed[l] = false;
+    needed[status.theWin()->self()] = true;
 
     for (i=plays-2; i>=forcing; i -= 2) {
-#ifndef NDEBUG
-        cout << "Untake " << external(moves[i+1]) << " and " << external(moves[i]) << endl;
-#endif
-        untake(original[i+1]);
-        untake(original[i]);
-    
-        // having 'untaken' some moves, see if skipping the current one leaves the
-        // forcing sequence a winner.  If so, we 'trim' this move and its answer from the
-        // list.
-        okay = true;
-        for (j=i+2; j<trimlim; j+=2) {
-            if (is_forcing(trimmed[j])) {
-#ifndef NDEBUG
-                cout << "Take(" << external(trimmed[j]) << ")" << endl;
-#endif                
-                take(trimmed[j]);
-                m = winner();                        // where opponent must block
-                if (m==trimmed[j+1]) {    // still on track
-#ifndef NDEBUG
-                    cout << "Give(" << external(m) << ")" << endl;
-#endif                
-                    give(m);
-                } else {
-#ifndef NDEBUG
-                    cout << "Now the force is to " << external(m) << " instead of "
-                        << external(trimmed[j+1]) << "; restoring " << external(original[i])
-                        << endl;
-#endif                
-#ifndef NDEBUG
-                cout << "Untake(" << external(trimmed[j]) << ")" << endl;
-#endif                
-                    untake(trimmed[j]);
-                    okay = false;
-                    break;
-                }
-            } else {
-#ifndef NDEBUG
-                cout << "Now " << external(trimmed[j]) << " is no longer forcing; have to leave "
-                    << external(original[i]) << " in the sequence" << endl;
-#endif                
-                okay = false;
-                break;
-            }
-        }
+        int mine = moves[i];
+        int reply = moves[i+1];
+        bool keep;
 
-        if (!canwin()) {
-#ifndef NDEBUG
-            if (okay) cout << "Now the end of the sequence is no longer a win; have to leave "
-                << external(original[i]) << " in the sequence" << endl;
-#endif                
-            okay = false;
+        t = win::joining(mine, reply);
+        keep = (t < 0);
+        for (k=0; !keep && (l = win::through(mine,k)) >= 0; k++) {
+            if (needed[l]) keep = true;     // a later threat (or the win) uses it
+            if (lines[l].Xcount() == 1 && lines[l].Ocount() == 3) keep = true;
         }
-
-#ifndef NDEBUG
-            cout << "Undoing testing, from " << i+2 << " to " << trimlim << endl;
-#endif                
-
-        // undo the results of testing
-        for (k=i+2; k<j; k+=2) {
-#ifndef NDEBUG
-            cout << "Untake(" << external(trimmed[k]) << ")" << endl;
-#endif                
-            untake(trimmed[k]);
-#ifndef NDEBUG
-            cout << "Untake(" << external(trimmed[k+1]) << ")" << endl;
-#endif                
-            untake(trimmed[k+1]);
+        for (k=0; !keep && (l = win::through(reply,k)) >= 0; k++) {
+            if (l != t && lines[l].Xcount() == 3 && lines[l].Ocount() == 1) keep = true;
         }
-        // if it's still okay, trim out this move and response
-        if (okay) {
-#ifndef NDEBUG
-            cout << "Trimming out " << external(original[i]) << " and " << external(original[i+1])
-                << endl;
-#endif                
-            for (j=i+2; j<trimlim; j+=2) {
-                trimmed[j-2] = trimmed[j];
-            }
-            trimlim -= 2;
+        if (keep) {
+            if (t >= 0) needed[t] = true;
+            kept++;
         }
-    }
-    
-    for (i=forcing; i<oplays; i+=2) {
 #ifndef NDEBUG
-        cout << "Take " << external(moves[i]) << "; give " << external(moves[i+1]) << endl;
+        else {
+            cout << "Trimming out " << external(mine) << " and " << external(reply) << endl;
+        }
 #endif
-        take(original[i]);
-        give(original[i+1]);
     }
-    Assert<bad_cleanup>(NASSERT || plays==oplays);
-    return oplays;
+    return forcing + 2*kept;
 }
 
 //********************************************************** is_forcing(int)
@@ -739,14 +1126,26 @@ board::challenge(int where, char *argcanonic) {
 
 //************************************************** outboard(std::ofstream)
 /**
- * Output the board to the given stream.
+ * Output the board to the given stream, followed by the strategic move it
+ * comes from if that's being kept.
  * \param strm a std::ofstream to send the results to.
  */
 void
 board::outboard(std::ofstream &strm) {
     char buf[65];
     setstdstring(buf);
-    strm << buf << endl;
+    long long started = timer::now();
+#ifdef PERFCOUNTERS
+    perfcounters::begin(perfcounters::OUTPUT);
+#endif
+    strm << buf;
+    if (origin >= 0) strm << ' ' << origin;
+    strm << endl;
+#ifdef PERFCOUNTERS
+    perfcounters::end(perfcounters::OUTPUT);
+#endif
+    account->ions += timer::now() - started;
+    account->positionsout++;
 }
 
 //****************************************** setstdstring(char *, iso **)
@@ -799,6 +1198,33 @@ board::setstdstring(const char *p, iso **theIso) {
     *rp = '\0';
 }
 
+//****************************************** setkey(poskey &, iso **)
+/**
+ * Packs the canonical form of the current board into a key, as setstdstring()
+ * does into a string.
+ * \param key (output) the key.
+ * \param theIso (output) the isomorphism used (optional)
+ */
+void
+board::setkey(poskey &key, iso **theIso) {
+    iso &view = *canonical();
+    if (theIso) *theIso = &view;
+
+    key.xs = key.os = 0;
+    for (int i=0; i<64; i++) {
+        switch(points[view.index[i]].val()) {
+        case point::X:
+        case point::BIGX:
+            key.xs |= 1ULL << i;
+            break;
+        case point::O:
+        case point::BIGO:
+            key.os |= 1ULL << i;
+            break;
+        }
+    }
+}
+
 //********************************************************** setposition(char *)
 /**
  * Set the board position according to a description string.  See strategic.cpp
@@ -846,6 +1272,27 @@ board::setposition(char *desc) {
     }
 }
 
+//********************************************************** setposition(const poskey &)
+/**
+ * Set the board position from a packed position.  The cells are filled in
+ * ascending order, as setposition(char *) does, so the board comes out the
+ * same either way.
+ * \param key the position.
+ */
+void
+board::setposition(const poskey &key) {
+    int i;
+
+    clear();
+    for (i=0; i<64; i++) {
+        if (key.xs >> i & 1) {
+            take(i);
+        } else if (key.os >> i & 1) {
+            give(i);
+        }
+    }
+}
+
 //****************************************** setmovelist(int, int[], int)
 /**
  * Set the movelist "list" to be all equivalent moves to the given one.  This is
@@ -896,7 +1343,7 @@ board::setmovelist(int where, int *list, int &count, iso *canonicIso) {
 }
 //****************************************** outtree(char *, int, char *)
 /**
- * Output a line of a tree view to the global stream 'tree'.
+ * Output a line of a tree view to the global stream 'tree', if it's open.
  * \param from starting position.
  * \param move the move madA.e
  * \param result what you get.
@@ -904,5 +1351,16 @@ board::setmovelist(int where, int *list, int &count, iso *canonicIso) {
  */
 void
 board::outtree(char *from,int move,char *result, char kind) {
+    if (!tree.is_open()) return;    // playing, or evaluating on several threads
+    long long started = timer::now();
+#ifdef PERFCOUNTERS
+    perfcounters::begin(perfcounters::OUTPUT);
+#endif
     tree << plays << ' ' << from << ' ' << move << ' ' << result << ' ' << kind << endl;
+#ifdef PERFCOUNTERS
+    perfcounters::end(perfcounters::OUTPUT);
+#endif
+    if (origins) origins->edge(origin, kind, from, move, result);
+    account->ions += timer::now() - started;
+    account->edges++;
 }
@@ -32,6 +32,10 @@
 #include "win.h"
 #include "iso.h"
 #include "statelist.h"
+#include "poskey.h"
+#include "solcache.h"
+#include "searchstats.h"
+#include "searchtrace.h"
 
 /// The game arena.
 /**
@@ -43,6 +47,7 @@
 
 class board {
 friend class line;
+friend class benchmark;
 private:
     point points[64];
     line  lines[76];
@@ -64,12 +69,25 @@ private:
 
     //! \brief Determine if there's a winning sequence of forces.
     bound sequence(int b);
+    bound pass(int b);      //!< \brief One timed pass of sequence().
     bound willwin(int b);
+    bound forkwin(int b);
+    bound setupwin(int b, int fork);
+    int forksetup(int where, const winset &twos, const winset &ones, const winset &otwos);
+    //! \brief Use a result of sequence() from an earlier run.
+    int cached(const solcache::solution &known, iso *myiso, bool verbose);
     int trim();             //!< removes unneeded moves
-    int itrim(int,int);     //!< used internal to trim()
+    /// Record an event of the search, if it's being traced.
+    void note(int what, int move) {
+        if (trace) trace->record(what, seqlevel, move, plays, seqboards);
+    }
     statelist status;       //!< census of each line state
     int seqlevel;
     int seqboards;
+    int seqdepth;           //!< Plays in the sequence the last search found.
+    long long proved;       //!< When the last search first found a winning move.
+    long long deadline;     //!< When the search is to give up, by timer::now(); 0 for never.
+    bool timedout;          //!< Whether the last search gave up at the deadline.
     bool haveSolution;
 public:
     board():status() {init();}  //!< \brief Construct and initialize
@@ -85,10 +103,30 @@ public:
             show(*canonical());
         }
     movenum strategicmove();    //!< \brief Find the strategic move for this position.
+    movenum dictionarymove();   //!< \brief Quickly find the strategic move, if any.
+    movenum bookmove();         //!< \brief Find the move in the compiled playbook.
+    unsigned long long census();    //!< \brief Sum up the states of the lines.
     movenum forced();           //!< \brief Find the forced move (if any).
     int winner();               //!< \brief Determine the winner.
     //! \brief Determine if there's a winning sequence of forces.
     int sequence(bool verbose);
+    //! \brief Search until a deadline, and fall back on the best-looking move.
+    int sequence(bool verbose, long long until, bool &proven);
+    int heuristic();            //!< \brief The empty point that scores best for me.
+    /// Boards searched between looks at the clock, when there's a deadline.
+    static const int CLOCKEVERY = 1024;
+    /// When set, a search with a deadline also gives up as soon as this is true.
+    volatile bool *halt;
+    searchstats stats;          //!< What the last call of sequence() did.
+    searchtrace *trace;         //!< Where to record the search, if anywhere.
+    /// Where the board adds in its time and output: the global report, unless
+    /// the board is one of several at work at once.
+    phasereport *account;
+    int origin;                 //!< The strategic move the work comes from, or -1.
+    int entry;                  //!< The entry strategicmove() last found, or -1.
+    int searched() {return seqboards;}  //!< Boards looked at by the last search.
+    int played() {return plays;}        //!< Moves on the board.
+    int solutiondepth() {return seqdepth;}  //!< Length of the last sequence found.
     int val(int i) {return points[i].val();}    //!< Who's here?
     void untake(int where);     //!< \brief Revoke a move.
     void take(int where);       //!< \brief Move to a spot.
@@ -118,8 +156,10 @@ public:
     /// Phase 1 validation output
     void outboard(std::ofstream &strm); //!< \brief Output the board.
     void setstdstring(const char *p, iso** theiso = NULL);  //!< \brief Describe the board.
+    void setkey(poskey &key, iso** theiso = NULL);          //!< \brief Pack the board.
     void challenge(int i, char *canonic);
     void setposition(char *);
+    void setposition(const poskey &);
     void setmovelist(int where, int *list, int &count, iso* theiso);
     void outtree(char *,int ,char *, char);     //!< \brief Output a line of the full tree.
 };
@@ -0,0 +1,303 @@
+/***************************************************************************
+                          dependencies.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class dependencies.
+ */
+
+#include <algorithm>
+#include <errno.h>
+#include <stdio.h>
+
+#include "dependencies.h"
+#include "strategic.h"
+#include "solcache.h"
+#include "keysort.h"
+#include "posreader.h"
+
+/// Whether a result in the cache is to be forgotten.
+struct doomed {
+    const poskey *keys;     ///< Positions whose wins no longer hold, in order.
+    long count;             ///< How many.
+    bool failures;          ///< Whether failures found with the dictionary go too.
+    bool all;               ///< Whether everything found with the dictionary goes.
+};
+
+//************************************************************************** isdoomed(const solcache::solution &, void *)
+/**
+ * Decide whether a result in the cache is to be forgotten.
+ * \param s the result.
+ * \param arg the doomed results.
+ * \return true if it's to go.
+ */
+static bool
+isdoomed(const solcache::solution &s, void *arg) {
+    doomed *d = (doomed *)arg;
+    poskey key;
+
+    if (d->all) return s.flags & solcache::LEAVES;
+    if (s.move < 0) return d->failures && (s.flags & solcache::LEAVES);
+    key.xs = s.xs;
+    key.os = s.os;
+    return std::binary_search(d->keys, d->keys + d->count, key);
+}
+
+dependencies::dependencies() {
+    out = NULL;
+    count = 0;
+    overflow = false;
+    removed = added = changed = 0;
+    forgotten = 0;
+    fresh = false;
+}
+
+//************************************************************************** open(const char *)
+/**
+ * Start adding to a file of dependencies.
+ * \param name the name of the file.
+ * \return false if it can't be opened.
+ */
+bool
+dependencies::open(const char *name) {
+    close();
+    out = fopen(name, "a");
+    return out != NULL;
+}
+
+//************************************************************************** close()
+/**
+ * Finish with the file.
+ */
+void
+dependencies::close() {
+    if (out) fclose(out);
+    out = NULL;
+}
+
+//************************************************************************** record(const poskey &)
+/**
+ * Write a line for a win that the dictionary helped to find: the position,
+ * and the dictionary positions the search used, or * if it used too many to
+ * keep track of.  A win found without the dictionary isn't written.
+ * \param key the position, in canonical form.
+ */
+void
+dependencies::record(const poskey &key) {
+    char buf[72];
+    int i;
+
+    if (!out || (count == 0 && !overflow)) return;
+    keysort::describe(key, buf);
+    fputs(buf, out);
+    if (overflow) {
+        fputs(" *", out);
+    } else {
+        for (i=0; i<count; i++) {
+            keysort::describe(strategic::find(used[i]).key, buf);
+            putc(' ', out);
+            fputs(buf, out);
+        }
+    }
+    putc('\n', out);
+}
+
+//************************************************************************** revise(const char *, solcache &)
+/**
+ * Compare the dictionary with the copy kept beside a file of dependencies,
+ * and forget the results that no longer hold: from the cache, and from the
+ * file.  Then keep a copy of the dictionary as it is now.  With no copy,
+ * there's nothing to compare with, and the wins in the cache may have been
+ * found with some other dictionary and never written to the file; so every
+ * result found with the dictionary as leaves is forgotten, and the file is
+ * started again.
+ * \param name the name of the file.
+ * \param cache the solution cache.
+ * \return false if the cache, the file or the copy can't be written.
+ */
+bool
+dependencies::revise(const char *name, solcache &cache) {
+    entry *now = new entry[strategic::count()];
+    entry *before = NULL, *nowend, *beforeend;
+    poskey *gone = NULL, *stale = NULL;
+    long ngone = 0, nstale = 0, stalesize = 0, kept = 0;
+    char copy[256], temp[256], line[4096], *field;
+    const char *at, *end;
+    FILE *in, *rewrite;
+    entry e;
+    int n = 0, size = 0;
+    bool doom, ok = true;
+
+    removed = added = changed = 0;
+    forgotten = 0;
+    nowend = now + current(now);
+    copyname(name, copy, sizeof(copy));
+    in = fopen(copy, "r");
+    fresh = !in;
+    if (fresh) {
+        doomed d;
+        d.keys = NULL;
+        d.count = 0;
+        d.failures = true;
+        d.all = true;
+        forgotten = cache.sweep(isdoomed, &d);
+        if (forgotten < 0) ok = false;
+        if (remove(name) != 0 && errno != ENOENT) ok = false;
+    } else {
+        while (fgets(line, sizeof(line), in)) {
+            field = strchr(line, ' ');
+            if (!field || !posreader::parse(line, field, e.key)) continue;
+            e.move = atoi(field + 1);
+            if (n == size) {
+                size = size ? 2 * size : 4096;
+                entry *more = new entry[size];
+                memcpy(more, before, n * sizeof(entry));
+                delete[] before;
+                before = more;
+            }
+            before[n++] = e;
+        }
+        fclose(in);
+        beforeend = before + n;
+        std::sort(before, beforeend);
+
+        // Walk the two in order, noting the positions whose wins may not hold.
+        gone = new poskey[n + 1];
+        entry *b = before, *a = now;
+        while (b < beforeend || a < nowend) {
+            if (a == nowend || (b < beforeend && b->key < a->key)) {
+                removed++;
+                gone[ngone++] = (b++)->key;
+            } else if (b == beforeend || a->key < b->key) {
+                added++;
+                a++;
+            } else {
+                if (a->move != b->move) {
+                    changed++;
+                    gone[ngone++] = a->key;
+                }
+                a++;
+                b++;
+            }
+        }
+    }
+
+    if (ngone > 0 || added > 0) {
+        // Find the wins that used them, and keep the lines of the others.
+        snprintf(temp, sizeof(temp), "%s.new", name);
+        in = fopen(name, "r");
+        rewrite = fopen(temp, "w");
+        if (!rewrite) ok = false;
+        while (in && rewrite && fgets(line, sizeof(line), in)) {
+            field = strchr(line, ' ');
+            if (!field || !posreader::parse(line, field, e.key)) continue;
+            // The dictionary positions used follow, each after a space.
+            doom = false;
+            for (at = field; !doom && *at == ' '; at = end) {
+                poskey used;
+                end = at + 1 + strcspn(at + 1, " \n");
+                doom = (at[1] == '*')
+                    || (posreader::parse(at + 1, end, used)
+                        && std::binary_search(gone, gone + ngone, used));
+            }
+            if (!doom) {
+                fputs(line, rewrite);
+                kept++;
+                continue;
+            }
+            if (nstale == stalesize) {
+                stalesize = stalesize ? 2 * stalesize : 4096;
+                poskey *more = new poskey[stalesize];
+                memcpy(more, stale, nstale * sizeof(poskey));
+                delete[] stale;
+                stale = more;
+            }
+            stale[nstale++] = e.key;
+        }
+        if (in) fclose(in);
+        if (rewrite && fclose(rewrite) != 0) ok = false;
+        if (ok && rename(temp, name) != 0) ok = false;
+
+        std::sort(stale, stale + nstale);
+        doomed d;
+        d.keys = stale;
+        d.count = nstale;
+        d.failures = added > 0;
+        d.all = false;
+        forgotten = cache.sweep(isdoomed, &d);
+        if (forgotten < 0) ok = false;
+    }
+    // Unless all went well, the next run compares with the old copy again.
+    if (ok) ok = snapshot(copy);
+    if (forgotten < 0) forgotten = 0;
+    delete[] stale;
+    delete[] gone;
+    delete[] before;
+    delete[] now;
+    return ok;
+}
+
+//************************************************************************** current(entry *)
+/**
+ * List the entries of the dictionary, in order of position.
+ * \param entries (output) the entries; room for strategic::count() of them.
+ * \return how many there are.
+ */
+int
+dependencies::current(entry *entries) {
+    int n = strategic::count();
+
+    for (int i=0; i<n; i++) {
+        entries[i].key = strategic::find(i).key;
+        entries[i].move = strategic::find(i).moveto;
+    }
+    std::sort(entries, entries + n);
+    return n;
+}
+
+//************************************************************************** snapshot(const char *)
+/**
+ * Keep a copy of the dictionary: each position, and its move.
+ * \param name the name of the copy.
+ * \return false if it can't be written.
+ */
+bool
+dependencies::snapshot(const char *name) {
+    entry *entries = new entry[strategic::count()];
+    int n = current(entries);
+    char buf[72];
+    FILE *f = fopen(name, "w");
+
+    if (f) {
+        for (int i=0; i<n; i++) {
+            keysort::describe(entries[i].key, buf);
+            fprintf(f, "%s %d\n", buf, entries[i].move);
+        }
+    }
+    delete[] entries;
+    return f && fclose(f) == 0;
+}
+
+//************************************************************************** copyname(const char *, char *, int)
+/**
+ * Name the copy of the dictionary that goes with a file of dependencies.
+ * \param name the file.
+ * \param buf (output) the name of the copy.
+ * \param size the size of \a buf.
+ */
+void
+dependencies::copyname(const char *name, char *buf, int size) {
+    snprintf(buf, size, "%s.dictionary", name);
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+                          dependencies.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class dependencies.
+ */
+
+#ifndef DEPENDENCIES_H
+#define DEPENDENCIES_H
+
+#include <stdio.h>
+
+#include "qval.h"
+#include "poskey.h"
+
+class solcache;
+
+/// What the wins in the solution cache owe to the dictionary, so that cached
+/// searches can be reused when it changes.
+
+/// With -D, a search stops at the positions of the dictionary, so a win it
+/// finds holds only as long as the dictionary keeps those positions and
+/// their moves.  With -K, each such win is written to a file as it goes into
+/// the cache, with the dictionary positions the search used, and a copy of
+/// the dictionary is written beside the file.
+///
+/// When a later run starts, revise() compares the dictionary with the copy.
+/// If it has changed, the wins that used a position that's gone, or whose
+/// move is different, are taken out of the cache, and so are their lines in
+/// the file.  If positions were added, the failures found with the
+/// dictionary go too, since a new position may turn one into a win.  The
+/// rest of the cache stands.  This is not an incremental revalidation:
+/// phases 1 to 3 still read all their input and check every position.
+/// What's reused is the searches whose results stood, which are found in the
+/// cache instead of being made again.
+///
+/// With no copy of the dictionary there's no telling what the wins already
+/// in the cache owe to it, since they were found without -K.  So the first
+/// run with -K forgets every result found with the dictionary as leaves, and
+/// starts the file afresh.
+
+class dependencies {
+public:
+    /// Positions remembered for one search; a search that uses more is taken
+    /// to depend on the whole dictionary.
+    static const int MOST = 48;
+    dependencies();
+    ~dependencies() {close();}
+    /// Start adding to a file of dependencies; false if it can't be opened.
+    bool open(const char *name);
+    /// Finish with it.
+    void close();
+    /// Start a search.
+    void clear() {
+        count = 0;
+        overflow = false;
+    }
+    /// Note that the search used an entry of the dictionary.
+    void use(int entry) {
+        for (int i=0; i<count; i++) {
+            if (used[i] == entry) return;
+        }
+        if (count < MOST) {
+            used[count++] = entry;
+        } else {
+            overflow = true;
+        }
+    }
+    /// Write what the win found for a position depended on.
+    void record(const poskey &key);
+    /// Bring the cache and the file up to date with the dictionary.
+    bool revise(const char *name, solcache &cache);
+    int removed;            ///< Positions gone from the dictionary.
+    int added;              ///< Positions new to it.
+    int changed;            ///< Positions whose move changed.
+    long forgotten;         ///< Results taken out of the cache.
+    bool fresh;             ///< Whether there was no copy of the dictionary.
+private:
+    FILE *out;              ///< The file being added to.
+    int used[MOST];         ///< Entries used by the search.
+    int count;              ///< How many.
+    bool overflow;          ///< Whether there were more.
+    /// An entry of the dictionary, as it's kept in the copy.
+    struct entry {
+        poskey key;
+        int move;
+        bool operator<(const entry &other) const {return key < other.key;}
+    };
+    static int current(entry *entries);
+    static bool snapshot(const char *name);
+    static void copyname(const char *name, char *buf, int size);
+};
+
+#endif
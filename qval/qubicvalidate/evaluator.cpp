@@ -0,0 +1,292 @@
+/***************************************************************************
+                          evaluator.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class evaluator.
+ */
+
+#include <stdio.h>
+
+#include "evaluator.h"
+#include "posreader.h"
+#include "timer.h"
+
+const char *evaluator::methodnames[METHODS] = {
+    "win", "forced", "book", "strategic", "cached", "search", "solved", "lost", "guess", "none",
+    "bad"
+};
+
+evaluator::evaluator() {
+    in = NULL;
+    packed = false;
+    headlen = headat = 0;
+    items = NULL;
+    nitems = next = 0;
+    boards = 0;
+    limit = 0;
+    for (int i=0; i<METHODS; i++) counts[i] = 0;
+}
+
+//************************************************************************** open(const char *)
+/**
+ * Start reading positions, and tell what kind they are.
+ * \param name the file, or NULL for the standard input.
+ * \return false if the file can't be opened.
+ */
+bool
+evaluator::open(const char *name) {
+    close();
+    in = name ? fopen(name, "rb") : stdin;
+    if (!in) return false;
+    headlen = fread(head, 1, sizeof(head), in);
+    headat = 0;
+    packed = false;
+    if (headlen == (int)sizeof(head)) {
+        for (int i=0; i<headlen; i++) {
+            if ((head[i] < ' ' || head[i] > '~') && !strchr("\t\r\n", head[i])) {
+                packed = true;
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+//************************************************************************** close()
+void
+evaluator::close() {
+    if (in && in != stdin) fclose(in);
+    in = NULL;
+    delete[] items;
+    items = NULL;
+}
+
+//************************************************************************** get()
+/**
+ * The next byte of the input, starting with the ones read by open().
+ * \return the byte, or EOF.
+ */
+int
+evaluator::get() {
+    if (headat < headlen) return head[headat++];
+    return getc(in);
+}
+
+//************************************************************************** read(item &)
+/**
+ * Read the next position.  A description may be followed by a space and
+ * more, such as the strategic move it comes from; that is left out.  The
+ * longest description kept is LONGEST characters, and a longer one is bad.
+ * \param it (output) the position.
+ * \return false at the end of the input.
+ */
+bool
+evaluator::read(item &it) {
+    int c, n = 0;
+
+    if (packed) {
+        unsigned char *p = (unsigned char *)&it.key;
+        for (n=0; n<(int)sizeof(it.key); n++) {
+            if ((c = get()) == EOF) return false;
+            p[n] = c;
+        }
+        it.ok = !(it.key.xs & it.key.os);
+        describe(it.key, it.text);
+    } else {
+        // Blank lines are passed over.
+        do {
+            bool cut = false;
+            n = 0;
+            while ((c = get()) != EOF && c != '\n') {
+                if (c == ' ' || c == '\r') cut = true;
+                if (!cut && n < LONGEST) it.text[n++] = c;
+            }
+        } while (n == 0 && c != EOF);
+        if (n == 0) return false;
+        it.text[n] = '\0';
+        it.ok = n < LONGEST && posreader::parse(it.text, it.text + n, it.key);
+    }
+    // The 1st player moves when both have played alike, the 2nd when it's one behind.
+    int lead = __builtin_popcountll(it.key.xs) - __builtin_popcountll(it.key.os);
+    if (it.ok && lead != 0 && lead != 1) it.ok = false;
+    return true;
+}
+
+//************************************************************************** describe(const poskey &, char *)
+/**
+ * Describe a position the way posreader reads it: each piece, with the
+ * number of empty cells before it if there are any.
+ * \param key the position.
+ * \param text (output) the description.
+ */
+void
+evaluator::describe(const poskey &key, char *text) {
+    int skip = 0;
+
+    for (int i=0; i<64; i++) {
+        if (!((key.xs | key.os) >> i & 1)) {
+            skip++;
+            continue;
+        }
+        if (skip) text += sprintf(text, "%d", skip);
+        *text++ = (key.xs >> i & 1) ? 'x' : 'o';
+        skip = 0;
+    }
+    *text = '\0';
+}
+
+//************************************************************************** choose(board &, method &, long long, solver *)
+/**
+ * Choose the move in the order makemove() does.  For the 1st player: a win,
+ * the reply to a force, the playbook, the dictionary, and a search for a
+ * forcing sequence.  With a limit, a search that runs out of time gives way
+ * to a guess.  If the search finds nothing, or it's the 2nd player's turn,
+ * the solver has what time is left, or solver::PATIENCE without a limit.
+ * \param b the board, with the position on it.
+ * \param how (output) how the move was found.
+ * \param limit nanoseconds allowed, or 0 for no limit.
+ * \param deep the solver, or NULL for none.
+ * \return the move, or -1 if there's none.
+ */
+int
+evaluator::choose(board &b, method &how, long long limit, solver *deep) {
+    long long started = (limit || deep) ? timer::now() : 0;
+    bool proven = true;
+    int m = -1;
+
+    if (b.played() % 2 == 0) {
+        if ((m = b.winner()) >= 0) {
+            how = WIN;
+        } else if ((m = b.forced()) >= 0) {
+            how = FORCED;
+        } else if ((m = b.bookmove()) >= 0) {
+            how = BOOK;
+        } else if ((m = b.strategicmove()) >= 0) {
+            how = STRATEGIC;
+        } else if (limit) {
+            m = b.sequence(false, started + limit, proven);
+            how = (m < 0) ? NONE : !proven ? GUESS : b.stats.cached ? CACHED : SEARCH;
+        } else {
+            m = b.sequence(false);
+            how = (m < 0) ? NONE : b.stats.cached ? CACHED : SEARCH;
+        }
+        if (how != NONE && how != GUESS) return m;
+    } else {
+        how = deep ? NONE : BAD;
+    }
+    if (!deep || (limit && timer::now() >= started + limit)) return m;
+
+    solver::value v;
+    m = deep->solve(b, limit ? started + limit : 0, v);
+    how = (m < 0) ? NONE : (v == solver::WIN) ? SOLVED : (v == solver::LOSS) ? LOST : GUESS;
+    return m;
+}
+
+//************************************************************************** evaluate(item &, worker &, long long)
+/**
+ * Find the move for one position.
+ * \param it the position, and where the result goes.
+ * \param w the thread's board and solver.
+ * \param limit nanoseconds allowed, or 0 for no limit.
+ */
+void
+evaluator::evaluate(item &it, worker &w, long long limit) {
+    long long started = timer::now();
+    board &b = w.b;
+
+    it.move = -1;
+    it.how = BAD;
+    it.boards = 0;
+    if (it.ok) {
+        try {
+            b.setposition(it.key);
+            w.deep.nodes = 0;
+            it.move = choose(b, it.how, limit, &w.deep);
+            // The forcing search was run if it came to that, and the solver after it.
+            if (b.played() % 2 == 0 && it.how >= SEARCH && it.how != BAD) it.boards = b.searched();
+            it.boards += w.deep.nodes;
+        } catch (...) {
+            // Not a position that can come up in play.
+            it.move = -1;
+            it.how = BAD;
+        }
+    }
+    it.ns = timer::now() - started;
+}
+
+//************************************************************************** working(void *)
+/**
+ * What each thread does: evaluate positions of the batch until there are
+ * none left.  Searches vary too much in length to hand them out in blocks.
+ * \param self the worker.
+ */
+void *
+evaluator::working(void *self) {
+    worker *w = (worker *)self;
+    evaluator *e = w->eval;
+    int i;
+
+    while ((i = __sync_fetch_and_add(&e->next, 1)) < e->nitems) {
+        evaluate(e->items[i], *w, e->limit);
+    }
+    return NULL;
+}
+
+//************************************************************************** run(FILE *, int)
+/**
+ * Evaluate all the positions, a batch at a time, and write the results in
+ * the order of the input.  What the boards did is added to the global report.
+ * \param out where to write.
+ * \param threads how many threads to work on; at least one.
+ * \return the number of positions.
+ */
+long
+evaluator::run(FILE *out, int threads) {
+    long total = 0;
+    int i;
+
+    if (threads < 1) threads = 1;
+    worker *crew = new worker[threads];
+    for (i=0; i<threads; i++) {
+        crew[i].eval = this;
+        crew[i].b.account = &crew[i].account;
+    }
+    if (!items) items = new item[BATCH];
+    for (;;) {
+        for (nitems=0; nitems<BATCH && read(items[nitems]); nitems++) ;
+        if (nitems == 0) break;
+        next = 0;
+        for (i=1; i<threads; i++) {
+            crew[i].started = pthread_create(&crew[i].thread, NULL, working, &crew[i]) == 0;
+        }
+        working(&crew[0]);
+        for (i=1; i<threads; i++) {
+            if (crew[i].started) pthread_join(crew[i].thread, NULL);
+        }
+        for (i=0; i<nitems; i++) {
+            item &it = items[i];
+            fprintf(out, "%s %d %s %d %lld\n", it.text, board::external(it.move),
+                    methodnames[it.how], it.boards, it.ns / 1000);
+            counts[it.how]++;
+            boards += it.boards;
+        }
+        total += nitems;
+    }
+    for (i=0; i<threads; i++) report.merge(crew[i].account);
+    report.positionsin += total;
+    delete[] crew;
+    return total;
+}
@@ -0,0 +1,113 @@
+/***************************************************************************
+                          evaluator.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class evaluator.
+ */
+
+#ifndef EVALUATOR_H
+#define EVALUATOR_H
+
+#include <stdio.h>
+#include <pthread.h>
+
+#include "qval.h"
+#include "poskey.h"
+#include "board.h"
+#include "phasereport.h"
+#include "solver.h"
+
+/// Finds the move to make in each of a stream of positions, on several threads.
+
+/// The positions come from a file or the standard input, either described
+/// one to a line as posreader reads them, or packed 16 bytes to a position
+/// as a poskey is.  The first 16 bytes tell which: text is all printable,
+/// and a packed position practically never is.  The positions are taken a
+/// batch at a time.  Each thread has a board and a report of its own, and
+/// takes positions from the batch until it's used up; then the results are
+/// written in the order the positions came in, one line each: the position,
+/// the move (in external form), how it was found, the boards searched, and
+/// the microseconds it took.  The move is found as makemove() would find it,
+/// but nothing is shown and nothing goes to the tree.
+///
+/// Where the forcing search finds nothing, and wherever the 2nd player is
+/// to move, each thread's solver takes over: "solved" means it proved a win,
+/// "lost" that every move loses, and "guess" that it proved neither.  With a
+/// limit on the time, a search that proves nothing in time gives way to the
+/// move board::heuristic() likes best, also a "guess".  A position that
+/// can't be read, or can't come up in a game, is written with the move -1
+/// and the method "bad".
+
+class evaluator {
+public:
+    /// How a move was found, in the order choose() tries them.
+    enum method {WIN, FORCED, BOOK, STRATEGIC, CACHED, SEARCH, SOLVED, LOST, GUESS, NONE, BAD,
+        METHODS};
+    static const char *methodnames[METHODS];    ///< What they're called in the output.
+
+    evaluator();
+    ~evaluator() {close();}
+    /// Start reading positions from a file, or from the standard input if NULL.
+    bool open(const char *name);
+    /// Stop reading.
+    void close();
+    /// Evaluate every position, writing the results; returns how many there were.
+    long run(FILE *out, int threads);
+    /// Choose the move for the player to move, as makemove() would.
+    static int choose(board &b, method &how, long long limit = 0, solver *deep = NULL);
+    bool packed;                ///< Whether the positions are packed.
+    long counts[METHODS];       ///< Positions whose move was found each way.
+    long long boards;           ///< Boards searched, in all.
+    long long limit;            ///< Nanoseconds allowed each position, or 0 for no limit.
+private:
+    static const int BATCH = 1024;      ///< Positions read at a time.
+    static const int LONGEST = 200;     ///< Longest description kept.
+    /// A position, and what was found for it.
+    struct item {
+        poskey key;
+        char text[LONGEST + 1]; ///< How it was described.
+        bool ok;                ///< Whether it could be read.
+        int move;
+        method how;
+        int boards;
+        long long ns;
+    };
+    /// A thread, and what it works with.
+    struct worker {
+        evaluator *eval;
+        pthread_t thread;
+        bool started;
+        board b;
+        phasereport account;
+        solver deep;
+        worker(): deep(&account) {}
+    };
+    FILE *in;
+    unsigned char head[16];     ///< The first bytes, read to tell the kind of input.
+    int headlen;
+    int headat;                 ///< How much of them has been taken.
+    item *items;                ///< The batch.
+    int nitems;
+    int next;                   ///< The next item for a thread to take.
+
+    int get();
+    bool read(item &it);
+    static void *working(void *self);
+    static void evaluate(item &it, worker &w, long long limit);
+    static void describe(const poskey &key, char *text);
+};
+
+#endif
@@ -0,0 +1,122 @@
+/***************************************************************************
+                          globals.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Globals shared by qubicvalidate and qubicbench.
+ */
+
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "qval.h"
+#include "solcache.h"
+#include "playbook.h"
+#include "originstats.h"
+#include "dependencies.h"
+#include "phasereport.h"
+#include "progress.h"
+
+/// output to phase1.out
+/*
+ * Gets positions where opponent is not forced.  These become the inputs
+ * to the rerun until all such positions have been generated.
+ */
+std::ofstream phaseout;
+/// output to checkstrategic.txt
+std::ofstream checkstrategic;
+/// ouput to base_strategic.out
+/**
+ * These are the strategic moves, copied when examining the base position.
+ * The file is used for comparison by the validation script.
+ */
+std::ofstream basestrategic;
+/// output to reachedstrategic.out.
+std::ofstream reachedstrategic;
+/// output to "treefile", which is based on "tree.out" or just "tree."
+/**
+ * Phase 1: <census> <start pos> <move> <nextpos> s (3068 lines)
+ *                strategic moves and their isomorphs
+ *
+ * Phase 2: <census> <start pos> <move> <nextpos> d (unforced player 2) (see main())
+ *          <census> <start pos> <move> <nextpos> r (first player forced) (see challenge())
+ *          <census> <start pos> <move> <nextpos> f (opponent was forced) (see mymoveat())
+ */
+std::ofstream tree;
+/// output to the statistics file named by -J: one JSON line per phase-3 position.
+std::ofstream statsout;
+
+/// The store of results of searches, if one is open.
+solcache *solutions = NULL;
+
+/// The compiled playbook, if one is open.
+playbook *book = NULL;
+
+/// The work charged to each strategic move, if it's being counted (-o).
+originstats *origins = NULL;
+
+/// Where the dictionary's part in the cached wins is written, if anywhere (-K).
+dependencies *depends = NULL;
+
+/// Where the time of the running phase goes.
+phasereport report;
+
+/// How far the running phase has got.
+progress meter;
+
+/// Global verbosity flag.
+bool verbose;
+/// Global flag: break all ties the same way, so runs are reproducible.
+bool deterministic;
+/// Global flag: a forcing sequence may end on a strategic position.
+bool strategicleaf;
+
+/// State of the generator behind qubicRandom().
+/**
+ * This is kept apart from the C library's random() so that nothing else in
+ * the process can disturb the sequence, and so that it can be seeded from
+ * the command line.
+ */
+static unsigned short randstate[3] = {0x330E, 0, 0};
+/// Guards randstate, for boards searching on several threads at once.
+static pthread_mutex_t randlock = PTHREAD_MUTEX_INITIALIZER;
+
+//************************************************************************** qubicRandom()
+/**
+ * The source of all random choices made by the program: ties between
+ * canonical forms and between equally good winning moves.
+ * \return a non-negative random number, or always zero in deterministic mode.
+ */
+long int
+qubicRandom() {
+    long int r;
+    if (deterministic) return 0;
+    pthread_mutex_lock(&randlock);
+    r = nrand48(randstate);
+    pthread_mutex_unlock(&randlock);
+    return r;
+}
+
+//************************************************************************** qubicSeed(long int)
+/**
+ * Seed the generator behind qubicRandom(), as srand48() would.
+ * \param seed the new seed.
+ */
+void
+qubicSeed(long int seed) {
+    randstate[0] = 0x330E;
+    randstate[1] = seed & 0xFFFF;
+    randstate[2] = (seed >> 16) & 0xFFFF;
+}
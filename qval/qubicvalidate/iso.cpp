@@ -80,6 +80,7 @@ ostream& operator<<(ostream&s, iso& what) {
 void
 iso::init(void) {
 	int i,j,k,ii,jj,kk;
+	if (nextiso > 0) return;	// already done
 	nextiso = 0;
 
 	for (i=0; i<192; i++) {
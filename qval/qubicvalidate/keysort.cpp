@@ -0,0 +1,367 @@
+/***************************************************************************
+                          keysort.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class template basic_keysort.
+ */
+
+#include <algorithm>
+#include <pthread.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "keysort.h"
+#include "posreader.h"
+
+/// Take a key from a position read.
+static void take(poskey &key, const posreader::position &p) {key = p.key;}
+static void take(originkey &key, const posreader::position &p) {
+    key.key = p.key;
+    key.origin = p.origin;
+}
+/// The position of a key.
+static const poskey &position(const poskey &key) {return key;}
+static const poskey &position(const originkey &key) {return key.key;}
+/// Add the origin to a description, if it has one.
+static void tag(const poskey &, char *) {}
+static void tag(const originkey &key, char *buf) {
+    if (key.origin >= 0) sprintf(buf + strlen(buf), " %d", key.origin);
+}
+
+/**
+ * Make a sorter.
+ * \param budget the bytes it may use for keys.
+ * \param threads the threads it may use for sorting.
+ */
+template <class T>
+basic_keysort<T>::basic_keysort(size_t budget, int threads) {
+    capacity = budget / sizeof(T);
+    if (capacity < 2 * FANIN) capacity = 2 * FANIN;
+    allocated = 0;
+    nthreads = (threads < 1) ? 1 : threads;
+    keys = NULL;
+    names = NULL;
+    read = written = 0;
+    runs = passes = 0;
+    snprintf(prefix, sizeof(prefix), "sortrun.%d", (int)getpid());
+}
+
+//************************************************************************** sort(const char *, const char *)
+/**
+ * Sort a file of positions, dropping duplicates.  The input is all read
+ * before the output is opened, so they may be the same file.
+ * \param in the name of the input.
+ * \param out the name of the output.
+ * \return false if the input can't be read or the output written.
+ */
+template <class T>
+bool
+basic_keysort<T>::sort(const char *in, const char *out) {
+    posreader input;
+    posreader::position p;
+    size_t count = 0;
+    int first, last, i;
+    FILE *f;
+    bool ok = true;
+
+    read = written = 0;
+    runs = passes = 0;
+    // With threads to spare, parse ahead of the sorting.
+    if (!input.open(in, nthreads > 1 ? 1 : 0)) return false;
+    // Start small, so that a small file doesn't pay for the whole budget.
+    allocated = (capacity < 65536) ? capacity : 65536;
+    keys = new T[allocated];
+    names = new char *[1];
+    while (input.next(p)) {
+        Assert<bad_arg>(NASSERT || p.ok);
+        if (count == allocated) {
+            allocated = (2 * allocated < capacity) ? 2 * allocated : capacity;
+            T *more = new T[allocated];
+            memcpy(more, keys, count * sizeof(T));
+            delete[] keys;
+            keys = more;
+        }
+        take(keys[count++], p);
+        read++;
+        if (count == capacity) {
+            f = fopen(runname(runs), "wb");
+            Assert<bad_init>(NASSERT || f);
+            spill(count, f, false);
+            fclose(f);
+            runs++;
+            count = 0;
+        }
+    }
+    input.close();
+
+    if (runs > 0 && count > 0) {
+        f = fopen(runname(runs), "wb");
+        Assert<bad_init>(NASSERT || f);
+        spill(count, f, false);
+        fclose(f);
+        runs++;
+        count = 0;
+    }
+    // Merge the runs down until one pass can finish them.
+    first = 0;
+    last = runs;
+    while (last - first > FANIN) {
+        for (i=first; i<last; i+=FANIN) {
+            int n = (last - i < FANIN) ? last - i : FANIN;
+            f = fopen(runname(runs), "wb");
+            Assert<bad_init>(NASSERT || f);
+            mergeruns(i, n, f, false);
+            fclose(f);
+            runs++;
+        }
+        passes++;
+        first = last;
+        last = runs;
+    }
+
+    f = fopen(out, "w");
+    if (f) {
+        if (last > first) {
+            mergeruns(first, last - first, f, true);
+            passes++;
+        } else {
+            spill(count, f, true);
+        }
+        ok = (fclose(f) == 0);
+    } else {
+        ok = false;
+        for (i=first; i<last; i++) unlink(names[i]);
+    }
+    for (i=0; i<runs; i++) delete[] names[i];
+    delete[] names;
+    names = NULL;
+    delete[] keys;
+    keys = NULL;
+    return ok;
+}
+
+//************************************************************************** describe(const poskey &, char *)
+/**
+ * Write the description of a position.  It's the form board::setstdstring()
+ * writes, and that board::setposition() and posreader read.
+ * \param key the position.
+ * \param buf (output) the description; 65 characters will do.
+ */
+template <class T>
+void
+basic_keysort<T>::describe(const poskey &key, char *buf) {
+    int i, blanks = 0;
+
+    for (i=0; i<64; i++) {
+        if (((key.xs | key.os) >> i & 1) == 0) {
+            blanks++;
+            continue;
+        }
+        if (blanks) {
+            if (blanks > 9) *buf++ = '0' + blanks / 10;
+            *buf++ = '0' + blanks % 10;
+            blanks = 0;
+        }
+        *buf++ = (key.xs >> i & 1) ? 'x' : 'o';
+    }
+    *buf = '\0';
+}
+
+//************************************************************************** spill(size_t, FILE *, bool)
+/**
+ * Sort the keys in memory and write them out without duplicates.  Each
+ * thread sorts a slice; then the slices are merged.
+ * \param count how many keys there are.
+ * \param out where to write them.
+ * \param text whether to write descriptions, or keys.
+ */
+template <class T>
+void
+basic_keysort<T>::spill(size_t count, FILE *out, bool text) {
+    int n = nthreads, i;
+
+    if (count < (size_t)n * 1024) n = 1;   // not worth the threads
+    slice *slices = new slice[n];
+    pthread_t *threads = new pthread_t[n];
+    bool *started = new bool[n];
+    source *sources = new source[n];
+    for (i=0; i<n; i++) {
+        slices[i].begin = keys + count * i / n;
+        slices[i].end = keys + count * (i + 1) / n;
+    }
+    for (i=1; i<n; i++) {
+        started[i] = (pthread_create(&threads[i], NULL, sortslice, &slices[i]) == 0);
+        if (!started[i]) sortslice(&slices[i]);
+    }
+    sortslice(&slices[0]);
+    for (i=1; i<n; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+    for (i=0; i<n; i++) {
+        sources[i].at = slices[i].begin;
+        sources[i].end = slices[i].end;
+        sources[i].file = NULL;
+    }
+    merge(sources, n, out, text);
+    delete[] sources;
+    delete[] started;
+    delete[] threads;
+    delete[] slices;
+}
+
+//************************************************************************** mergeruns(int, int, FILE *, bool)
+/**
+ * Merge some runs on disk, and remove them.  The memory for keys is shared
+ * out among them as buffers.
+ * \param first the first run.
+ * \param count how many runs.
+ * \param out where to write the merge.
+ * \param text whether to write descriptions, or keys.
+ */
+template <class T>
+void
+basic_keysort<T>::mergeruns(int first, int count, FILE *out, bool text) {
+    source *sources = new source[count];
+    size_t each = capacity / count;
+    int i;
+
+    for (i=0; i<count; i++) {
+        sources[i].file = fopen(names[first + i], "rb");
+        Assert<bad_init>(NASSERT || sources[i].file);
+        sources[i].buf = keys + each * i;
+        sources[i].bufsize = each;
+        sources[i].at = sources[i].end = sources[i].buf;
+    }
+    merge(sources, count, out, text);
+    for (i=0; i<count; i++) {
+        fclose(sources[i].file);
+        unlink(names[first + i]);
+    }
+    delete[] sources;
+}
+
+//************************************************************************** merge(source *, int, FILE *, bool)
+/**
+ * Merge sorted sources, writing each key once.  The sources are kept in a
+ * heap on their next keys.
+ * \param sources the sources.
+ * \param count how many.
+ * \param out where to write the merge.
+ * \param text whether to write descriptions, or keys.
+ */
+template <class T>
+void
+basic_keysort<T>::merge(source *sources, int count, FILE *out, bool text) {
+    int *heap = new int[count];
+    int n = 0, i, child, top;
+    T last;
+    bool any = false;
+    char buf[72];
+
+    // Build the heap, bubbling each source up into place.
+    for (i=0; i<count; i++) {
+        if (sources[i].at == sources[i].end && !refill(sources[i])) continue;
+        child = n++;
+        while (child > 0 && *sources[i].at < *sources[heap[(child - 1) / 2]].at) {
+            heap[child] = heap[(child - 1) / 2];
+            child = (child - 1) / 2;
+        }
+        heap[child] = i;
+    }
+    while (n > 0) {
+        source &s = sources[heap[0]];
+        if (!any || position(*s.at) != position(last)) {
+            last = *s.at;
+            any = true;
+            if (text) {
+                describe(position(last), buf);
+                tag(last, buf);
+                fputs(buf, out);
+                putc('\n', out);
+                written++;
+            } else {
+                fwrite(&last, sizeof(last), 1, out);
+            }
+        }
+        // Move on in the top source, and sift it down.
+        if (++s.at == s.end && !refill(s)) heap[0] = heap[--n];
+        top = heap[0];
+        i = 0;
+        while ((child = 2 * i + 1) < n) {
+            if (child + 1 < n && *sources[heap[child + 1]].at < *sources[heap[child]].at) child++;
+            if (!(*sources[heap[child]].at < *sources[top].at)) break;
+            heap[i] = heap[child];
+            i = child;
+        }
+        heap[i] = top;
+    }
+    delete[] heap;
+}
+
+//************************************************************************** refill(source &)
+/**
+ * Read more keys into a source's buffer.
+ * \param s the source.
+ * \return false if it has no more.
+ */
+template <class T>
+bool
+basic_keysort<T>::refill(source &s) {
+    size_t n;
+
+    if (!s.file) return false;
+    n = fread(s.buf, sizeof(T), s.bufsize, s.file);
+    s.at = s.buf;
+    s.end = s.buf + n;
+    return n > 0;
+}
+
+//************************************************************************** sortslice(void *)
+/**
+ * Sort one slice of the keys; the body of a sorting thread.
+ * \param s the slice.
+ */
+template <class T>
+void *
+basic_keysort<T>::sortslice(void *s) {
+    slice *sl = (slice *)s;
+    std::sort(sl->begin, sl->end);
+    return NULL;
+}
+
+//************************************************************************** runname(int)
+/**
+ * Name a run, making room for the name if need be.
+ * \param n the number of the run.
+ * \return its name.
+ */
+template <class T>
+char *
+basic_keysort<T>::runname(int n) {
+    // names has room for the next power of 2 at or above n
+    if (n > 0 && (n & (n - 1)) == 0) {
+        char **more = new char *[2 * n];
+        memcpy(more, names, n * sizeof(char *));
+        delete[] names;
+        names = more;
+    }
+    names[n] = new char[48];
+    snprintf(names[n], 48, "%s.%d", prefix, n);
+    return names[n];
+}
+
+template class basic_keysort<poskey>;
+template class basic_keysort<originkey>;
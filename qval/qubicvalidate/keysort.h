@@ -0,0 +1,105 @@
+/***************************************************************************
+                          keysort.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class template basic_keysort.
+ */
+
+#ifndef KEYSORT_H
+#define KEYSORT_H
+
+#include <stdio.h>
+#include <sys/types.h>
+
+#include "qval.h"
+#include "poskey.h"
+
+/// A position, with the strategic move it descends from.
+struct originkey {
+    poskey key;             ///< The position.
+    int origin;             ///< Index of the strategic move; -1 if unknown.
+    /// Ordering, for sorting: by position, and then the lowest origin first,
+    /// with an unknown one last.
+    bool operator<(const originkey &other) const {
+        return key < other.key
+            || (key == other.key && (unsigned int)origin < (unsigned int)other.origin);
+    }
+};
+
+/// Sorts a file of positions and drops the duplicates, in bounded memory.
+
+/// The positions are read as packed keys, 16 bytes each, until the memory
+/// budget is full.  The keys in memory are then sorted in slices, one thread
+/// to a slice, and the slices are merged into a sorted run on disk.  When
+/// the input is used up the runs are merged, many at a time, and each key is
+/// written once as a description, ready for the next phase to read.  When
+/// everything fits in memory there are no runs, and the output is written
+/// straight from the merge of the slices.
+///
+/// The positions are expected to be canonical already, as board::outboard()
+/// writes them, so that equal keys mean equal positions.
+///
+/// The template argument is what's sorted: a poskey for plain positions
+/// (keysort), or an originkey for positions that carry the strategic move
+/// they descend from (originsort).  The latter keeps the lowest origin of
+/// each position, at 24 bytes a key.
+
+template <class T>
+class basic_keysort {
+public:
+    basic_keysort(size_t budget = 256 << 20, int threads = 1);
+    /// Sort \a in into \a out; returns false if either can't be used.
+    bool sort(const char *in, const char *out);
+    /// Write the description of a position, as board::setstdstring() would.
+    static void describe(const poskey &key, char *buf);
+    long long read;         ///< Positions read.
+    long long written;      ///< Positions written.
+    int runs;               ///< Runs made on disk.
+    int passes;             ///< Merge passes over the runs, the last included.
+private:
+    static const int FANIN = 64;    ///< Most runs merged at once.
+    /// Somewhere to take keys from, in order.
+    struct source {
+        const T *at;        ///< The next key.
+        const T *end;       ///< The end of those in hand.
+        FILE *file;         ///< Where more come from, if anywhere.
+        T *buf;             ///< Buffer for them.
+        size_t bufsize;     ///< Its size, in keys.
+    };
+    /// One slice of the keys in memory, for a sorting thread.
+    struct slice {
+        T *begin;
+        T *end;
+    };
+    size_t capacity;        ///< Keys that fit in the budget.
+    size_t allocated;       ///< Keys there's room for now.
+    int nthreads;
+    T *keys;                ///< The keys in memory.
+    char **names;           ///< The runs on disk.
+    char prefix[32];        ///< Start of their names.
+
+    void spill(size_t count, FILE *out, bool text);
+    void mergeruns(int first, int count, FILE *out, bool text);
+    void merge(source *sources, int count, FILE *out, bool text);
+    static bool refill(source &s);
+    static void *sortslice(void *s);
+    char *runname(int n);
+};
+
+typedef basic_keysort<poskey> keysort;          ///< Sorts plain positions.
+typedef basic_keysort<originkey> originsort;    ///< Sorts positions with their origins.
+
+#endif
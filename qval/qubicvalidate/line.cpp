@@ -23,8 +23,9 @@
 
 void
 line::makeme(int what) {
+		int was = mylist()->mystate();
 		drop();
-		whose->status.makeme(what, this);
+		whose->status.makeme(was, what, this);
 }
 
 void
@@ -25,6 +25,7 @@
 #include <iostream>
 #include <stdlib.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "qval.h"
 #include "iso.h"
@@ -33,43 +34,91 @@
 #include "line.h"
 #include "board.h"
 #include "strategic.h"
+#include "solcache.h"
+#include "phasereport.h"
+#include "perfcounters.h"
+#include "progress.h"
+#include "searchtrace.h"
+#include "posreader.h"
+#include "keysort.h"
+#include "originstats.h"
+#include "dependencies.h"
+#include "shards.h"
+#include "playbook.h"
+#include "evaluator.h"
+#include "server.h"
+#include "ponderer.h"
+#include "solver.h"
+#include "proofgraph.h"
+#include "timer.h"
 
-/// output to phase1.out
-/*
- * Gets positions where opponent is not forced.  These become the inputs
- * to the rerun until all such positions have been generated.
- */
-std::ofstream phaseout;
-/// output to checkstrategic.txt
-std::ofstream checkstrategic;
-/// ouput to base_strategic.out
+//************************************************************************** readposition(posreader &, char *, poskey &, int &)
 /**
- * These are the strategic moves, copied when examining the base position.
- * The file is used for comparison by the validation script.
+ * Get the next position description, adding the time it takes to the report.
+ * \param in the input.
+ * \param line (output) the description.
+ * \param key (output) the position it describes.
+ * \param origin (output) the strategic move it comes from, or -1.
+ * \return false at the end of the input.
  */
-std::ofstream basestrategic;
-/// output to reachedstrategic.out.
-std::ofstream reachedstrategic;
-/// output to "treefile", which is based on "tree.out" or just "tree."
+static bool
+readposition(posreader &in, char *line, poskey &key, int &origin) {
+    posreader::position p;
+    long long started = timer::now();
+    bool got = in.next(p) && p.length < 65;
+    report.ions += timer::now() - started;
+    if (!got) return false;
+    memcpy(line, p.text, p.length);
+    line[p.length] = '\0';
+    Assert<bad_arg>(NASSERT || p.ok);
+    key = p.key;
+    origin = p.origin;
+    report.positionsin++;
+    return true;
+}
+
+//************************************************************************** sortpositions(const char *, const char *, int, int)
 /**
- * Phase 1: <census> <start pos> <move> <nextpos> s (3068 lines)
- *                strategic moves and their isomorphs
- *
- * Phase 2: <census> <start pos> <move> <nextpos> d (unforced player 2) (see main())
- *          <census> <start pos> <move> <nextpos> r (first player forced) (see challenge())
- *          <census> <start pos> <move> <nextpos> f (opponent was forced) (see mymoveat())
+ * Sort a file of positions into another, without the duplicates, with a
+ * keysort or an originsort.
+ * \param in the name of the input.
+ * \param out the name of the output, which may be the same.
+ * \param megabytes the memory to use for the positions.
+ * \param threads the threads to use for sorting.
  */
-std::ofstream tree;
-/// output to "phase2.in"
-std::ifstream prior;
-/// input from "checkfile", which is "checkstrategic.uniq" or based on  "check.*"
+template <class sorter>
+static void
+sortpositions(const char *in, const char *out, int megabytes, int threads) {
+    sorter sorting((size_t)megabytes << 20, threads);
+    long long started = timer::now();
+
+    if (!sorting.sort(in, out)) {
+        cerr << "Cannot sort " << in << " into " << out << endl;
+        exit(1);
+    }
+    cerr << "Sorted " << sorting.read << " positions from " << in << " into "
+        << sorting.written << " in " << out << " (" << sorting.runs << " runs, "
+        << sorting.passes << " merge passes, " << fixed << setprecision(2)
+        << (timer::now() - started) / 1e9 << " s)" << endl;
+}
+
+//************************************************************************** dedup(const char *, const char *, int, int)
 /**
- * Only the check.* files are used in the current regime.
+ * Sort a file of positions into another, without the duplicates.  When
+ * origins are kept, each position keeps the lowest of its origins.
+ * \param in the name of the input.
+ * \param out the name of the output, which may be the same.
+ * \param megabytes the memory to use for the positions.
+ * \param threads the threads to use for sorting.
  */
-std::ifstream readstrategic;
-
-/// Global verbosity flag.
-bool verbose;
+static void
+dedup(const char *in, const char *out, int megabytes, int threads) {
+    if (origins) {
+        sortpositions<originsort>(in, out, megabytes, threads);
+    } else {
+        sortpositions<keysort>(in, out, megabytes, threads);
+    }
+}
 
 void
 readmove(board *b) {
@@ -90,13 +139,19 @@ readmove(board *b) {
 }
 
 
-//************************************************************************** makemove(board *)
-// makemove(board *b) -- the heart of the matter
+//************************************************************************** makemove(board *, long long, ponderer *, solver *)
+// makemove(board *b, long long limit, ponderer *pondered, solver *deep) -- the heart of the matter
 //    Choose a move, in this order:
 //        1. If there's a win, take it straightaway
 //        2. Otherwise, if the opponent is forcing, reply as required
-//        3. Otherwise, look for a "strategic" move, if any.
-//        4. Otherwise, find a forcing sequence and begin it.
+//        3. Otherwise, look the position up in the compiled playbook, if any.
+//        4. Otherwise, look for a "strategic" move, if any.
+//        5. Otherwise, take the answer found while the opponent was thinking,
+//           if there is one.
+//        6. Otherwise, find a forcing sequence and begin it; with a limit,
+//           give up when the time is up, and take the best-looking move.
+//        7. Otherwise, if there's time, search the whole game with the solver,
+//           and take the best move it can find, proven or not.
 // The work of Oren Patashnik showed that this procedure works,
 // and guarantees a win.  The tricky bits are finding the
 // "strategic" moves, which Oren did and which I copied, and
@@ -104,7 +159,9 @@ readmove(board *b) {
 // version 0.1, the sequence finding is pretty much brute-force,
 // and I rely on a fast processor to make it workable.
 int
-makemove(board *b) {
+makemove(board *b, long long limit, ponderer *pondered, solver *deep) {
+    long long started = timer::now();
+    bool proven;
     int m,r;
     r=0;
     m = b->winner();
@@ -120,11 +177,36 @@ makemove(board *b) {
         r = 1;    // there's a winner
     }
     if (m < 0) {
-        m = b->strategicmove();
+        m = b->bookmove();
     }
     if (m < 0) {
+        m = b->strategicmove();
+    }
+    if (m < 0 && pondered) {
+        m = pondered->find(*b);
+        if (m >= 0 && verbose) {
+            cout << "I saw that coming." << endl;
+        }
+    }
+    if (m < 0 && limit) {
+        m = b->sequence(verbose, started + limit, proven);
+        // The solver may do better than a hunch in the time that's left.
+        if (!proven && deep && timer::now() < started + limit) m = -1;
+    } else if (m < 0) {
       m = b->sequence(verbose);
     }
+    if (m < 0 && deep) {
+        solver::value v;
+        m = deep->solve(*b, limit ? started + limit : 0, v);
+        if (verbose && v == solver::WIN) {
+            cout << "I can win this the long way round." << endl;
+        } else if (verbose && v == solver::LOSS) {
+            cout << "I think you have me, but let's see you prove it." << endl;
+        } else if (verbose) {
+            cout << "Looked " << deep->depth << " plies ahead and found nothing sure;"
+                << " I'll play my hunch." << endl;
+        }
+    }
     if (m<0) {
         cout << "Can find no move" << endl;
         b->show();
@@ -141,15 +223,77 @@ makemove(board *b) {
 //************************************************************************** usage(char *)
 static void
 usage(char *me) {
-    cout << "usage: " << me << " [-v] [-V] [phasenumber] [-s[suffix]]" << endl;
+    cout << "usage: " << me << " [-v] [-V] [-d] [-r<seed>] [-c[cachefile]] [-D] [-J[statsfile]]"
+        << " [-P<secs>] [-F<statusfile>] [-T<nodes>[,<ms>]] [-j<threads>] [-u[in,out]]"
+        << " [-m<MB>] [-n<shards>] [-b<bookfile>] [-o[originsfile]] [-K[depfile]] [-t<ms>] [-p]"
+        << " [phasenumber | eval [file] | serve <socket>] [-s[suffix]]"
+        << endl;
     cout << "       -v: verbose: Qubic brags about how well it's doing" << endl;
     cout << "       -V: version: print the version number and exit" << endl;
+    cout << "       -d: deterministic: always break ties the same way" << endl;
+    cout << "       -r: seed the random tie-breaking with <seed>" << endl;
+    cout << "       -c: keep search results in <cachefile> (default solutions.cache)" << endl;
+    cout << "       -D: dictionary: end forcing sequences at strategic positions" << endl;
+    cout << "       -J: write search statistics to <statsfile> (default searchstats.json)"
+        << endl;
+    cout << "       -P: report progress every <secs> seconds, or never if 0 (default 10)"
+        << endl;
+    cout << "       -F: write progress to <statusfile> as JSON, instead of to stderr;" << endl;
+    cout << "           with -n, each worker to <statusfile>.<shard>" << endl;
+    cout << "       -T: trace searches of at least <nodes> boards or <ms> milliseconds" << endl;
+    cout << "           into trace.<suffix>, for qubictrace" << endl;
+    cout << "       -j: parse the input of phases 2 and 3 ahead on <threads> threads"
+        << " (default 0)," << endl;
+    cout << "           and sort on as many; in eval or serve, work on as many"
+        << " (default one per processor)" << endl;
+    cout << "       -u: after phase 1 or 2, sort its output into the next phase's input"
+        << endl;
+    cout << "           without duplicates; or, with no phase, sort <in> into <out>" << endl;
+    cout << "       -m: use <MB> megabytes of memory for sorting (default 256)" << endl;
+    cout << "       -n: run phase 2 or 3 as <shards> processes, each on the positions"
+        << endl;
+    cout << "           that hash to it, and gather their outputs" << endl;
+    cout << "       -b: in play (phase 0), take moves from <bookfile>, made by qubiccompile"
+        << endl;
+    cout << "           or, for the fastest wins, by qubicproof -d" << endl;
+    cout << "       -o: tag positions with the strategic move they come from, and add"
+        << endl;
+    cout << "           the work of the phase to each one's totals in <originsfile>"
+        << " (default origins.out)," << endl;
+    cout << "           and its 1st player's moves to <originsfile>.moves" << endl;
+    cout << "       -K: with -c in phase 3, reuse cached searches across dictionary changes:"
+        << endl;
+    cout << "           write the dictionary positions each cached win used to <depfile>"
+        << endl;
+    cout << "           (default dependencies.out), and first forget the results that a"
+        << endl;
+    cout << "           change to the dictionary since the last run undoes (the first time,"
+        << endl;
+    cout << "           all the results found with the dictionary); every position is still"
+        << endl;
+    cout << "           checked, and only the searches whose results stand are skipped" << endl;
+    cout << "       -t: in play, eval or serve, give up a search after <ms> milliseconds,"
+        << endl;
+    cout << "           and make the move that looks best instead" << endl;
+    cout << "       -p: in play, work out answers to the likely replies while waiting for one"
+        << endl;
+    cout << "       eval: find the move for each position in <file> (or the standard input),"
+        << endl;
+    cout << "           described or packed, as play would, and write it with how it was"
+        << " found" << endl;
+    cout << "       serve: play either side in the games of any number of clients of"
+        << endl;
+    cout << "           the Unix socket <socket>, one move list to a line, until interrupted"
+        << endl;
 }
 
 //************************************************************************** main(int, char **)
 /**
  * The usual thing.  Usage:
- *     qval [-v] [-V] [phasenumber] [-s[suffix]]
+ *     qval [-v] [-V] [-d] [-r<seed>] [-c[cachefile]] [-D] [-J[statsfile]] [-P<secs>]
+ *          [-F<statusfile>] [-T<nodes>[,<ms>]] [-j<threads>] [-u[in,out]] [-m<MB>]
+ *          [-n<shards>] [-b<bookfile>] [-o[originsfile]] [-K[depfile]] [-t<ms>] [-p]
+ *          [phasenumber | eval [file] | serve <socket>] [-s[suffix]]
  *
  * Get it started, run through the steps, quit.
  */
@@ -157,10 +301,40 @@ int main(int argc, char *argv[])
 {
     int argn;
     verbose = false;
+    deterministic = false;
+    strategicleaf = false;
     bool sayVersion = false;
     long int phase = -1;
     char *endptr;
     char checkfile[20],treefile[20];
+    const char *cachefile = NULL;
+    const char *statsfile = NULL;
+    searchtrace *tracer = NULL;
+    FILE *tracefile = NULL;
+    posreader positions;
+    int parsers = 0;
+    bool sorting = false;
+    char *sortin = NULL, *sortout = NULL;
+    int sortmb = 256;
+    int nshards = 1;
+    int shard = -1;
+    const char *bookfile = NULL;
+    playbook compiled;
+    const char *originsfile = NULL;
+    originstats counted;
+    int origin;
+    const char *depfile = NULL;
+    dependencies tracked;
+    const char *operand = NULL;
+    long long movelimit = 0;
+    bool pondering = false;
+    ponderer *thinker = NULL;
+    solver *deep = NULL;
+    evaluator evaluated;
+    server served;
+    poskey key;
+    long long searchstart;
+    solcache cache;
 
     strncpy(checkfile,"checkstrategic.uniq",20);
     strncpy(treefile,"tree.out",20);
@@ -171,14 +345,26 @@ int main(int argc, char *argv[])
 #endif
 
     for (argn=1; argn<argc; argn++) {
-        if (*argv[argn] != '-') {
+        if (*argv[argn] != '-' || (phase == 4 && !operand && argv[argn][1] == '\0')) {
             // non-switch arg
+            if (phase >= 4 && !operand) {
+                // The positions to evaluate ("-" for the standard input), or
+                // the socket to serve on.
+                operand = argv[argn];
+                continue;
+            }
             if (phase >= 0) {
                 usage(argv[0]);
                 exit(1);
             } else {
-                phase = strtol(argv[argn], &endptr, 10);
-                if (*endptr) {
+                if (strcmp(argv[argn], "eval") == 0) {
+                    phase = 4;
+                } else if (strcmp(argv[argn], "serve") == 0) {
+                    phase = 5;
+                } else {
+                    phase = strtol(argv[argn], &endptr, 10);
+                }
+                if (phase < 4 && *endptr) {
                     // There should be no non-converted chars
                     cerr << "Unconverted chars" << endl;
                     usage(argv[0]);
@@ -192,6 +378,118 @@ int main(int argc, char *argv[])
                         break;
         case 'V': sayVersion = true;
                         break;
+        case 'd': deterministic = true;
+                        break;
+        case 'r':
+                    qubicSeed(strtol(&argv[argn][2], &endptr, 10));
+                    if (argv[argn][2] == '\0' || *endptr) {
+                        cerr << "Bad -r switch" << endl;
+                        usage(argv[0]);
+                        exit(1);
+                    }
+                    break;
+        case 'D': strategicleaf = true;
+                        break;
+        case 'c':
+                    cachefile = argv[argn][2] ? &argv[argn][2] : "solutions.cache";
+                    break;
+        case 'J':
+                    statsfile = argv[argn][2] ? &argv[argn][2] : "searchstats.json";
+                    break;
+        case 'P':
+                    meter.interval = strtol(&argv[argn][2], &endptr, 10);
+                    if (argv[argn][2] == '\0' || *endptr || meter.interval < 0) {
+                        cerr << "Bad -P switch" << endl;
+                        usage(argv[0]);
+                        exit(1);
+                    }
+                    break;
+        case 'T':
+                    tracer = new searchtrace;
+                    tracer->minnodes = strtol(&argv[argn][2], &endptr, 10);
+                    if (*endptr == ',') {
+                        // With a time given, 0 boards means no limit on boards.
+                        if (tracer->minnodes == 0) tracer->minnodes = ~0U;
+                        tracer->minns = strtol(endptr + 1, &endptr, 10) * 1000000ULL;
+                    } else {
+                        tracer->minns = ~0ULL;
+                    }
+                    if (argv[argn][2] == '\0' || *endptr) {
+                        cerr << "Bad -T switch" << endl;
+                        usage(argv[0]);
+                        exit(1);
+                    }
+                    break;
+        case 'j':
+                    parsers = strtol(&argv[argn][2], &endptr, 10);
+                    if (argv[argn][2] == '\0' || *endptr || parsers < 0) {
+                        cerr << "Bad -j switch" << endl;
+                        usage(argv[0]);
+                        exit(1);
+                    }
+                    break;
+        case 'u':
+                    sorting = true;
+                    if (argv[argn][2]) {
+                        sortin = &argv[argn][2];
+                        sortout = strchr(sortin, ',');
+                        if (!sortout || sortout == sortin || !sortout[1]) {
+                            cerr << "Bad -u switch" << endl;
+                            usage(argv[0]);
+                            exit(1);
+                        }
+                        *sortout++ = '\0';
+                    }
+                    break;
+        case 'm':
+                    sortmb = strtol(&argv[argn][2], &endptr, 10);
+                    if (argv[argn][2] == '\0' || *endptr || sortmb <= 0) {
+                        cerr << "Bad -m switch" << endl;
+                        usage(argv[0]);
+                        exit(1);
+                    }
+                    break;
+        case 'n':
+                    nshards = strtol(&argv[argn][2], &endptr, 10);
+                    if (argv[argn][2] == '\0' || *endptr || nshards < 1) {
+                        cerr << "Bad -n switch" << endl;
+                        usage(argv[0]);
+                        exit(1);
+                    }
+                    break;
+        case 'b':
+                    if (argv[argn][2] == '\0') {
+                        cerr << "Bad -b switch" << endl;
+                        usage(argv[0]);
+                        exit(1);
+                    }
+                    bookfile = &argv[argn][2];
+                    break;
+        case 'o':
+                    originsfile = argv[argn][2] ? &argv[argn][2] : "origins.out";
+                    origins = &counted;
+                    break;
+        case 'K':
+                    depfile = argv[argn][2] ? &argv[argn][2] : "dependencies.out";
+                    break;
+        case 'p': pondering = true;
+                        break;
+        case 't':
+                    movelimit = strtol(&argv[argn][2], &endptr, 10) * 1000000LL;
+                    if (argv[argn][2] == '\0' || *endptr || movelimit <= 0) {
+                        cerr << "Bad -t switch" << endl;
+                        usage(argv[0]);
+                        exit(1);
+                    }
+                    break;
+        case 'F':
+                    if (argv[argn][2] == '\0') {
+                        cerr << "Bad -F switch" << endl;
+                        usage(argv[0]);
+                        exit(1);
+                    }
+                    meter.statusfile = &argv[argn][2];
+                    break;
         case 's':
                     if ((phase != 3)) {
                         cerr << "Bad -s switch" << endl;
@@ -211,10 +509,161 @@ int main(int argc, char *argv[])
         }
     }
     
+    if (sortin) {
+        if (phase >= 0) {
+            cerr << "-u with files is not for a phase" << endl;
+            usage(argv[0]);
+            exit(1);
+        }
+        dedup(sortin, sortout, sortmb, parsers);
+        exit(0);
+    }
+    if (sorting && phase != 1 && phase != 2) {
+        cerr << "-u needs phase 1 or 2, or files" << endl;
+        usage(argv[0]);
+        exit(1);
+    }
+
+    if (phase == 5 && !operand) {
+        cerr << "serve needs a socket" << endl;
+        usage(argv[0]);
+        exit(1);
+    }
+    if (originsfile && (phase < 1 || phase > 3)) {
+        cerr << "-o needs phase 1, 2 or 3" << endl;
+        usage(argv[0]);
+        exit(1);
+    }
+
     if (verbose) {
         cout << "treefile is " << treefile << endl;
         cout << "checkfile is " << checkfile << endl;
     }
+    if (depfile) {
+        if (phase != 3 || !cachefile) {
+            cerr << "-K needs phase 3 and -c" << endl;
+            usage(argv[0]);
+            exit(1);
+        }
+        // Done once, before any worker uses the cache.
+        iso::init();
+        win::init();
+        strategic::init();
+        if (!cache.open(cachefile)) {
+            cerr << "Cannot open solution cache " << cachefile << endl;
+            exit(1);
+        }
+        if (!tracked.revise(depfile, cache)) {
+            cerr << "Cannot bring " << depfile << " up to date" << endl;
+            exit(1);
+        }
+        if (tracked.fresh) {
+            cerr << "No copy of the dictionary beside " << depfile << "; "
+                << tracked.forgotten << " results found with it forgotten" << endl;
+        } else if (tracked.removed || tracked.added || tracked.changed) {
+            cerr << "The dictionary has lost " << tracked.removed << " positions, gained "
+                << tracked.added << " and changed " << tracked.changed << "; "
+                << tracked.forgotten << " results forgotten" << endl;
+        }
+        cache.close();
+    }
+    shards pool(nshards);
+    const char *input = (phase == 2) ? "phase2.in" : checkfile;
+    if (nshards > 1) {
+        if (phase != 2 && phase != 3) {
+            cerr << "-n needs phase 2 or 3" << endl;
+            usage(argv[0]);
+            exit(1);
+        }
+        if (!pool.split(input)) {
+            cerr << "Cannot split " << input << " into shards" << endl;
+            exit(1);
+        }
+        shard = pool.start();
+        if (shard < 0 && pool.failed) {
+            // What the others wrote would look like the whole of the output.
+            cerr << pool.failed << " of " << nshards << " workers failed; nothing gathered,"
+                << " and the shards are left as they are" << endl;
+            exit(1);
+        }
+        if (shard < 0) {
+            // The workers are done; gather what they wrote.
+            bool ok = true;
+            if (phase == 2) {
+                ok = pool.gather("checkstrategic.txt", true) && ok;
+                ok = pool.gather("phase2.out", false) && ok;
+                ok = pool.gather("tree.out", true) && ok;
+            } else {
+                char name[24];
+                ok = pool.gather("reachedstrategic.out", true) && ok;
+                ok = pool.gather(treefile, true) && ok;
+                if (statsfile) ok = pool.gather(statsfile, true) && ok;
+                if (tracer) {
+                    strcpy(name, "trace");
+                    strcat(name, &treefile[4]);
+                    ok = pool.gather(name, true) && ok;
+                }
+            }
+            if (depfile) ok = pool.gather(depfile, true) && ok;
+            if (originsfile) {
+                // Each shard's totals are added up as the file is rewritten,
+                // and its moves counted once with the others.
+                char movesfile[256];
+                originstats::movesname(originsfile, movesfile, sizeof(movesfile));
+                ok = pool.gather(originsfile, true) && ok;
+                ok = pool.gather(movesfile, true) && ok;
+                if (ok && !counted.save(originsfile)) ok = false;
+            }
+            if (!ok) cerr << "Cannot gather the outputs of the shards" << endl;
+            pool.cleanup();
+            if (ok && sorting) dedup("checkstrategic.txt", "checkstrategic.uniq", sortmb, parsers);
+            exit(ok ? 0 : 1);
+        }
+        sorting = false;    // done once, by the parent
+    }
+    if (cachefile) {
+        // Each worker opens the cache for itself, so that their locks work.
+        if (!cache.open(cachefile)) {
+            cerr << "Cannot open solution cache " << cachefile << endl;
+            exit(1);
+        }
+        solutions = &cache;
+    }
+    if (bookfile) {
+        if (!compiled.open(bookfile)) {
+            cerr << "Cannot open playbook " << bookfile << endl;
+            exit(1);
+        }
+        book = &compiled;
+    }
+    if (shard >= 0) {
+        // The shard's directory goes with cleanup(), so its status file is kept beside it.
+        static char status[256];
+        if (meter.statusfile) {
+            snprintf(status, sizeof(status), "%s%s.%d",
+                    meter.statusfile[0] == '/' ? "" : "../", meter.statusfile, shard);
+            meter.statusfile = status;
+        }
+        meter.shard = shard;
+        if (!pool.enter(shard)) {
+            cerr << "Cannot enter shard " << shard << endl;
+            exit(1);
+        }
+        // Every copy of a position is in this shard, so this drops them all.
+        dedup(input, input, sortmb, parsers);
+    }
+    if (depfile) {
+        if (!tracked.open(depfile)) {
+            cerr << "Cannot write " << depfile << endl;
+            exit(1);
+        }
+        depends = &tracked;
+    }
+#ifdef PERFCOUNTERS
+    if (!perfcounters::open()) {
+        cerr << "Cannot open the performance counters; going on without them" << endl;
+    }
+#endif
 
     try {
         char inputline[65];
@@ -223,11 +672,15 @@ int main(int argc, char *argv[])
         int movelist[64];
         int movecount;
 
-        int checked = 0, dots = 0;
+        int checked = 0;
         int i, st, move;
+        report.begin(phase);
+        long long started = timer::now();
         iso::init();                // Build the isomorphisms of the Qubic board
         win::init();                // Find the winning lines
         strategic::init();          // Prepare 2929 strategic moves
+        proofgraph::init();         // and the tables the solver shares
+        report.initns = timer::now() - started;
 
         board b;                    // must come after initializations
         
@@ -242,8 +695,32 @@ int main(int argc, char *argv[])
         //                      in which case this will have to be considered some more.
         // Phase 3: check the accumulated positions which should be strategic, they
         //                    actually should be either strategic or forced wins.    
+        // Phase 0: not a phase of the validation, but a game against a person, who
+        //                    moves second.
+        // Phase 4 (eval): not a phase either, but the move for each of a file of
+        //                    positions, found on several threads.
+        // Phase 5 (serve): not a phase either, but any number of games at once,
+        //                    played for clients of a local socket.
     
         switch(phase) {
+        case 0:
+            b.clear();
+            b.show();
+            if (pondering) thinker = new ponderer;      // its board comes after the tables
+            deep = new solver;
+            while (!makemove(&b, movelimit, thinker, deep)) {
+                if (thinker) thinker->start(b);
+                cout << "Your move? ";
+                readmove(&b);
+                if (thinker) thinker->stop();
+            }
+            if (thinker && verbose) {
+                cout << thinker->pondered << " replies answered ahead, "
+                    << thinker->used << " of them used" << endl;
+            }
+            delete thinker;
+            delete deep;
+            break;
         case 1:
             // Phase 1 Outputs
             // to base_strategic.out: the raw strategic position
@@ -252,9 +729,16 @@ int main(int argc, char *argv[])
             phaseout.open("phase1.out");
             basestrategic.open("base_strategic.out", ios::out);
             tree.open("tree.out", ios::out);
+            report.output("checkstrategic.txt");
+            report.output("phase1.out");
+            report.output("base_strategic.out");
+            report.output("tree.out");
+            meter.begin(1, 2929);
             for (st=0; st<2929; st++) {
+                report.positionsin++;
                 // Set up the board from the strategic object
                 strategic &strat = strategic::find(st);
+                meter.position(strat.pattern);
                 b.clear();
                 for (i=0; i<64; i++) {
                     switch (strat.points[i]) {
@@ -267,6 +751,10 @@ int main(int argc, char *argv[])
                     }
                 }
                 b.setstdstring(startcanonic);
+                if (origins) {
+                    b.origin = st;
+                    origins->position(st);
+                }
                 // Show the starting position
                 b.outboard(basestrategic);
                 // Compute the appearance of the board after the move (but restore it)
@@ -286,11 +774,14 @@ int main(int argc, char *argv[])
                 for (i=0; i<movecount; i++) {
                     b.outtree(startcanonic, movelist[i], resultcanonic, 's');
                 }
+                meter.finished(0);
             }
+            meter.end();
             phaseout.close();
             checkstrategic.close();
             basestrategic.close();
             tree.close();
+            if (sorting) dedup("phase1.out", "phase2.in", sortmb, parsers);
             break;
         case 2:
             /*
@@ -301,12 +792,22 @@ int main(int argc, char *argv[])
              */
             checkstrategic.open("checkstrategic.txt",ios::app);
             phaseout.open("phase2.out", ios::out);
-            prior.open("phase2.in",ios::in);
+            if (!positions.open("phase2.in", parsers)) cerr << "Cannot read phase2.in" << endl;
             tree.open("tree.out", ios::app);
+            report.input("phase2.in");
+            report.output("checkstrategic.txt");
+            report.output("phase2.out");
+            report.output("tree.out");
 
-            while (prior.getline(inputline,65)) {
-                b.setposition(inputline);
+            meter.begin(2, positions.lines());
+            while (readposition(positions, inputline, key, origin)) {
+                meter.position(inputline);
+                b.setposition(key);
                 b.setstdstring(startcanonic);
+                if (origins) {
+                    b.origin = origin;
+                    origins->position(origin);
+                }
                 if (b.canwin()) {
                     b.challenge(b.winner(),resultcanonic);
                 } else {
@@ -317,54 +818,155 @@ int main(int argc, char *argv[])
                         }
                     }
                 }
+                meter.finished(0);
             }
-            prior.close();
+            meter.end();
+            positions.close();
             phaseout.close();
             checkstrategic.close();
             tree.close();
+            if (sorting) dedup("checkstrategic.txt", "checkstrategic.uniq", sortmb, parsers);
             break;
             
         case 3:
             cout << endl << "Checking " << checkfile << " into " << treefile << endl;
-            readstrategic.open(checkfile, ios::in);
+            if (!positions.open(checkfile, parsers)) cerr << "Cannot read " << checkfile << endl;
             reachedstrategic.open("reachedstrategic.out", ios::app);
             tree.open(treefile, ios::app);
-            while (readstrategic.getline(inputline,65)) {
+            if (statsfile) statsout.open(statsfile, ios::app);
+            if (tracer) {
+                // trace.out or trace.<suffix>, to go with the tree file
+                char name[24];
+                strcpy(name, "trace");
+                strcat(name, &treefile[4]);
+                tracefile = fopen(name, "ab");
+                if (!tracefile) {
+                    cerr << "Cannot open " << name << endl;
+                    exit(1);
+                }
+                b.trace = tracer;
+            }
+            report.input(checkfile);
+            report.output("reachedstrategic.out");
+            report.output(treefile);
+            if (statsfile) report.output(statsfile);
+            meter.begin(3, positions.lines());
+            while (readposition(positions, inputline, key, origin)) {
                 ++checked;
-                cout << "+" ;
-                if ((++dots % 100) == 0) { cout << " " << checked << endl; }
-                cout.flush();
+                meter.position(inputline);
                 tree << endl << inputline << ' ' << checked << endl;
-                b.setposition(inputline);
+                b.setposition(key);
                 b.setstdstring(startcanonic);
+                if (origins) {
+                    b.origin = origin;
+                    origins->position(origin);
+                }
                 if (b.forced() >=0) {
                     cerr << endl << "Forced position included in checkstrategic: " << inputline
                         << endl;
+                    if (statsout.is_open()) {
+                        b.stats.clear();
+                        b.stats.write(statsout, inputline, checked, "forced", -1, 0, 0);
+                    }
+                    meter.finished(0);
                     continue;
                 }
                 // Only need search if there's no strategic move
                 if (b.strategicmove() == -1 ) {
                     // no strategic move: find forcing sequence and report the sequence.
+                    if (tracer) tracer->clear();
+                    searchstart = timer::now();
                     move = b.sequence(verbose);
+                    if (tracer) {
+                        tracer->keep(tracefile, inputline, move, b.searched(),
+                                timer::now() - searchstart);
+                    }
+                    if (origins) origins->search(origin, b.searched());
                     if (move == -1) {
                         cerr << endl << "No forced sequence for " << inputline << " ("
                             << startcanonic << ")" << endl;
                     }
+                    if (statsout.is_open()) {
+                        b.stats.write(statsout, inputline, checked, (move >= 0) ? "win" : "none",
+                                board::external(move), b.solutiondepth(), b.searched());
+                    }
+                    meter.finished(b.searched());
                 } else {
                     // It appears this is strategic.  Say we got here.
                     b.outboard(reachedstrategic);
+                    if (statsout.is_open()) {
+                        b.stats.clear();
+                        b.stats.write(statsout, inputline, checked, "strategic", -1, 0, 0);
+                    }
+                    meter.finished(0);
                 }
             }
-            cerr << endl << checked << " checked!" << endl;
-            readstrategic.close();
+            meter.end();
+            cerr << checked << " checked!" << endl;
+            if (solutions) {
+                cerr << solutions->hits << " found in the cache, "
+                    << solutions->stores << " added to it" << endl;
+            }
+            positions.close();
             reachedstrategic.close();
             tree.close();
+            statsout.close();
+            if (tracefile) fclose(tracefile);
+            break;
+
+        case 4:
+            if (!evaluated.open((operand && strcmp(operand, "-")) ? operand : NULL)) {
+                cerr << "Cannot read " << operand << endl;
+                exit(1);
+            }
+            if (operand && strcmp(operand, "-")) report.input(operand);
+            if (parsers == 0) parsers = sysconf(_SC_NPROCESSORS_ONLN);
+            evaluated.limit = movelimit;
+            evaluated.run(stdout, parsers);
+            evaluated.close();
+            fflush(stdout);
+            cerr << report.positionsin << " positions evaluated";
+            for (i=0; i<evaluator::METHODS; i++) {
+                if (evaluated.counts[i]) {
+                    cerr << ", " << evaluated.counts[i] << ' ' << evaluator::methodnames[i];
+                }
+            }
+            cerr << "; " << evaluated.boards << " boards searched" << endl;
+            if (solutions) {
+                cerr << solutions->hits << " found in the cache, "
+                    << solutions->stores << " added to it" << endl;
+            }
+            break;
+
+        case 5:
+            if (!served.open(operand)) {
+                cerr << "Cannot serve on " << operand << endl;
+                exit(1);
+            }
+            if (parsers == 0) parsers = sysconf(_SC_NPROCESSORS_ONLN);
+            cerr << "Serving on " << operand << " with " << parsers << " threads" << endl;
+            served.limit = movelimit;
+            served.run(parsers);
+            served.close();
+            cerr << served.sessions << " connections, " << served.requests << " requests, "
+                << served.errors << " errors" << endl;
+            if (solutions) {
+                cerr << solutions->hits << " found in the cache, "
+                    << solutions->stores << " added to it" << endl;
+            }
             break;
 
         default:
             Assert<bad_arg>(0);
             break;
         }
+        if (origins && phase > 0 && !origins->save(originsfile)) {
+            cerr << "Cannot write " << originsfile << endl;
+        }
+        report.end(cerr);
+#ifdef PERFCOUNTERS
+        perfcounters::report(cerr);
+#endif
     } catch(bad_arg &e) {
         cerr << endl << "BAD_ARG EXCEPTION NOT CAUGHT" << endl;
         throw;
@@ -0,0 +1,238 @@
+/***************************************************************************
+                          originstats.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class originstats.
+ */
+
+#include <algorithm>
+#include <stdio.h>
+
+#include "originstats.h"
+#include "posreader.h"
+#include "keysort.h"
+#include "proofgraph.h"
+
+originstats::originstats() {
+    for (int i=0; i<ORIGINS; i++) {
+        positions[i] = edges[i] = boards[i] = 0;
+        moves[i] = 0;
+    }
+    rejected = 0;
+    used = NULL;
+    nused = usedsize = 0;
+}
+
+originstats::originstats(const originstats &other) {
+    for (int i=0; i<ORIGINS; i++) {
+        positions[i] = other.positions[i];
+        edges[i] = other.edges[i];
+        boards[i] = other.boards[i];
+        moves[i] = other.moves[i];
+    }
+    rejected = other.rejected;
+    nused = usedsize = other.nused;
+    used = nused ? new move[nused] : NULL;
+    std::copy(other.used, other.used + nused, used);
+}
+
+//************************************************************************** edge(int, char, const char *, int, const char *)
+/**
+ * Count a line of the tree, and keep the move if it's one of the 1st
+ * player's: a strategic move (s), a forced one (r), or one found by search
+ * or in the dictionary (c).  The move is made on the position it's from,
+ * and kept only if that makes the result; some 'c' lines carry a move made
+ * from further back.
+ * \param origin the strategic move it comes from, or -1.
+ * \param kind the kind of line.
+ * \param from the canonical position moved from.
+ * \param cell the move, as seen from \a from.
+ * \param result the canonical position it makes.
+ */
+void
+originstats::edge(int origin, char kind, const char *from, int cell, const char *result) {
+    poskey child;
+    move m;
+
+    if (origin < 0) return;
+    edges[origin]++;
+    if (kind != 's' && kind != 'r' && kind != 'c') return;
+    if (!posreader::parse(from, from + strlen(from), m.from)
+            || !posreader::parse(result, result + strlen(result), m.to)
+            || cell < 0 || cell > 63 || (m.from.xs | m.from.os) >> cell & 1) {
+        rejected++;
+        return;
+    }
+    child.xs = m.from.xs | 1ULL << cell;
+    child.os = m.from.os;
+    if (proofgraph::canonical(child) != m.to) {
+        rejected++;
+        return;
+    }
+    m.origin = origin;
+    m.cell = cell;
+    keep(m);
+}
+
+//************************************************************************** keep(const move &)
+void
+originstats::keep(const move &m) {
+    if (nused == usedsize) {
+        usedsize = usedsize ? 2 * usedsize : 4096;
+        move *more = new move[usedsize];
+        std::copy(used, used + nused, more);
+        delete[] used;
+        used = more;
+    }
+    used[nused++] = m;
+}
+
+//************************************************************************** add(const char *)
+/**
+ * Add the counts in a file to these.  A strategic move may appear in the
+ * file more than once; its lines are all added.  The moves column isn't
+ * added, since the same move may be in more than one line; save() counts
+ * the moves again from their own file.
+ * \param name the name of the file.
+ * \return false if it can't be read.
+ */
+bool
+originstats::add(const char *name) {
+    FILE *in = fopen(name, "r");
+    char line[256];
+    long long p, e, b;
+    int st;
+
+    if (!in) return false;
+    while (fgets(line, sizeof(line), in)) {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%d %lld %lld %lld", &st, &p, &e, &b) != 4) continue;
+        if (st < 0 || st >= ORIGINS) continue;
+        positions[st] += p;
+        edges[st] += e;
+        boards[st] += b;
+    }
+    fclose(in);
+    return true;
+}
+
+//************************************************************************** addmoves(const char *)
+/**
+ * Add the moves in a file of moves to these.
+ * \param name the name of the file.
+ * \return false if it can't be read.
+ */
+bool
+originstats::addmoves(const char *name) {
+    FILE *in = fopen(name, "r");
+    char line[256], from[80], to[80];
+    move m;
+
+    if (!in) return false;
+    while (fgets(line, sizeof(line), in)) {
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%d %79s %d %79s", &m.origin, from, &m.cell, to) != 4) continue;
+        if (m.origin < 0 || m.origin >= ORIGINS) continue;
+        // The empty board is written as a dash.
+        m.from = poskey();
+        if (strcmp(from, "-") && !posreader::parse(from, from + strlen(from), m.from)) continue;
+        if (!posreader::parse(to, to + strlen(to), m.to)) continue;
+        keep(m);
+    }
+    fclose(in);
+    return true;
+}
+
+//************************************************************************** savemoves(const char *)
+/**
+ * Write the different moves, each once, in order of strategic move and
+ * position, and count them for each strategic move.  Each line has the
+ * strategic move, the position moved from (a dash if it's empty), the cell,
+ * and the position moved to.
+ * \param name the name of the file.
+ * \return false if it can't be written.
+ */
+bool
+originstats::savemoves(const char *name) {
+    char from[72], to[72];
+    FILE *out;
+    long i;
+
+    std::sort(used, used + nused);
+    nused = std::unique(used, used + nused) - used;
+    for (i=0; i<ORIGINS; i++) moves[i] = 0;
+    out = fopen(name, "w");
+    if (!out) return false;
+    fprintf(out, "# strategic from move to\n");
+    for (i=0; i<nused; i++) {
+        moves[used[i].origin]++;
+        keysort::describe(used[i].from, from);
+        keysort::describe(used[i].to, to);
+        if (!from[0]) strcpy(from, "-");
+        fprintf(out, "%d %s %d %s\n", used[i].origin, from, used[i].cell, to);
+    }
+    return fclose(out) == 0;
+}
+
+//************************************************************************** save(const char *)
+/**
+ * Add these counts to those in a file, and these moves to those in the file
+ * of moves beside it, and write them back.  The counts file has a line for
+ * each strategic move that has any: its index, the positions, tree lines
+ * and boards, and the number of different moves.  The counts here are left
+ * as they were.
+ * \param name the name of the file.
+ * \return false if it can't be written.
+ */
+bool
+originstats::save(const char *name) {
+    originstats *total = new originstats(*this);
+    char movesfile[256];
+    FILE *out;
+    bool ok;
+
+    // Nothing there yet is fine.
+    movesname(name, movesfile, sizeof(movesfile));
+    total->add(name);
+    total->addmoves(movesfile);
+    ok = total->savemoves(movesfile);
+    out = fopen(name, "w");
+    if (!out) {
+        delete total;
+        return false;
+    }
+    fprintf(out, "# strategic positions edges boards moves\n");
+    for (int i=0; i<ORIGINS; i++) {
+        if (!total->positions[i] && !total->edges[i] && !total->boards[i]) continue;
+        fprintf(out, "%d %lld %lld %lld %lld\n", i, total->positions[i], total->edges[i],
+                total->boards[i], total->moves[i]);
+    }
+    ok = (fclose(out) == 0) && ok;
+    delete total;
+    return ok;
+}
+
+//************************************************************************** movesname(const char *, char *, int)
+/**
+ * Name the file of moves that goes with a file of counts.
+ * \param name the file of counts.
+ * \param buf (output) the name of the file of moves.
+ * \param size the size of \a buf.
+ */
+void
+originstats::movesname(const char *name, char *buf, int size) {
+    snprintf(buf, size, "%s.moves", name);
+}
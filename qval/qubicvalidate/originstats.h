@@ -0,0 +1,104 @@
+/***************************************************************************
+                          originstats.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class originstats.
+ */
+
+#ifndef ORIGINSTATS_H
+#define ORIGINSTATS_H
+
+#include "qval.h"
+#include "poskey.h"
+
+/// The work of the validation, charged to the strategic moves it comes from.
+
+/// With -o, phase 1 tags every position it writes with the index of the
+/// strategic move it started from, and the later phases pass the tag on to
+/// the positions that descend from it.  A position reached from several
+/// strategic moves is charged to the lowest of them (see originsort).  As
+/// each phase works, it counts up for each strategic move the positions it
+/// took in, the lines it added to the tree (which is how big the full tree
+/// is), the boards its searches looked at, and the moves the 1st player
+/// made.
+///
+/// A move is kept as the canonical position it's made from and the one it
+/// makes, since a cell number only means something in the frame of its own
+/// position; a move that doesn't make the position the tree says it does
+/// isn't kept.  Moves that make the same position from the same one are the
+/// same move.  The moves go to a file of their own beside the counts (see
+/// movesname()), one line each, and the count of the different ones is
+/// what the counts file shows.
+///
+/// The counters belong to the one process that counts them, so they need no
+/// locking; the workers of a sharded phase each keep their own.  save() adds
+/// them to what the files already hold, so one pair of files sums up every
+/// phase and every shard.
+
+class originstats {
+public:
+    static const int ORIGINS = 2929;    ///< The strategic moves.
+    originstats();
+    ~originstats() {delete[] used;}
+    originstats(const originstats &other);
+    /// Count a position taken in.
+    void position(int origin) {
+        if (origin >= 0) positions[origin]++;
+    }
+    /// Count a line of the tree, from \a from by \a move to \a result.
+    void edge(int origin, char kind, const char *from, int move, const char *result);
+    /// Count the boards a search looked at.
+    void search(int origin, long count) {
+        if (origin >= 0) boards[origin] += count;
+    }
+    /// Add the counts in a file to these; false if it can't be read.
+    bool add(const char *name);
+    /// Add these counts to the file's, and these moves to its moves; false if they can't be written.
+    bool save(const char *name);
+    /// Name the file of moves that goes with a file of counts.
+    static void movesname(const char *name, char *buf, int size);
+    long long positions[ORIGINS];   ///< Positions taken in.
+    long long edges[ORIGINS];       ///< Lines of the tree written.
+    long long boards[ORIGINS];      ///< Boards searched.
+    long long moves[ORIGINS];       ///< Different moves of the 1st player, once saved.
+    long rejected;                  ///< Moves left out because they didn't make their result.
+private:
+    /// A move of the 1st player.
+    struct move {
+        int origin;
+        poskey from;            ///< Canonical.
+        poskey to;              ///< Canonical.
+        int cell;               ///< In the frame of \a from.
+        bool operator<(const move &other) const {
+            if (origin != other.origin) return origin < other.origin;
+            if (from != other.from) return from < other.from;
+            if (to != other.to) return to < other.to;
+            return cell < other.cell;
+        }
+        /// The same move, whatever cell it's written with.
+        bool operator==(const move &other) const {
+            return origin == other.origin && from == other.from && to == other.to;
+        }
+    };
+    move *used;             ///< The moves made.
+    long nused;
+    long usedsize;
+    void keep(const move &m);
+    bool addmoves(const char *name);
+    bool savemoves(const char *name);
+};
+
+#endif
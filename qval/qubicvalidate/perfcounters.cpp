@@ -0,0 +1,217 @@
+/***************************************************************************
+                          perfcounters.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class perfcounters.
+ */
+
+#include "perfcounters.h"
+
+#ifdef PERFCOUNTERS
+
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+const char *perfcounters::names[KERNELS] = {"sequence", "canonical", "strategicmove", "output"};
+const int perfcounters::every[KERNELS] = {1, 64, 16, 64};
+__thread perfcounters::counts perfcounters::kernels[KERNELS];
+__thread int perfcounters::fd[EVENTS] = {-1, -1, -1, -1};
+__thread bool perfcounters::opened = false;
+__thread bool perfcounters::tried = false;
+perfcounters::counts perfcounters::merged[KERNELS];
+pthread_mutex_t perfcounters::lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_key_t perfcounters::leaving;
+bool perfcounters::wanted = false;
+
+//************************************************************************** open()
+/**
+ * Open the counters for this thread, and let the threads to come open
+ * theirs.  Call it before starting any.  This fails if the kernel or the
+ * hardware doesn't have them, or if perf_event_paranoid forbids it.
+ * \return true if they're counting.
+ */
+bool
+perfcounters::open() {
+    static bool keyed = false;
+
+    if (!keyed) keyed = pthread_key_create(&leaving, detach) == 0;
+    memset(merged, 0, sizeof(merged));
+    tried = true;
+    wanted = keyed && group();
+    return wanted;
+}
+
+//************************************************************************** attach()
+/**
+ * Open counters for a thread other than the one that called open(), the
+ * first time it begins a kernel, and arrange for its totals to be kept when
+ * it ends.
+ * \return true if it has them.
+ */
+bool
+perfcounters::attach() {
+    if (!wanted || tried) return false;
+    tried = true;
+    if (!group()) return false;
+    pthread_setspecific(leaving, (void *)1);
+    return true;
+}
+
+//************************************************************************** detach(void *)
+/**
+ * Keep the totals of a thread that's ending, and close its counters.
+ */
+void
+perfcounters::detach(void *unused) {
+    merge();
+    release();
+}
+
+//************************************************************************** merge()
+/**
+ * Add this thread's totals to the process's, and start them again.
+ */
+void
+perfcounters::merge() {
+    pthread_mutex_lock(&lock);
+    for (int k=0; k<KERNELS; k++) {
+        merged[k].calls += kernels[k].calls;
+        merged[k].measured += kernels[k].measured;
+        for (int e=0; e<EVENTS; e++) merged[k].total[e] += kernels[k].total[e];
+        kernels[k].calls = kernels[k].measured = 0;
+        memset(kernels[k].total, 0, sizeof(kernels[k].total));
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+//************************************************************************** group()
+/**
+ * Open this thread's counters as one group, and start them.
+ * \return true if they're counting.
+ */
+bool
+perfcounters::group() {
+    static const unsigned long long config[EVENTS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    struct perf_event_attr attr;
+    int e;
+
+    for (e=0; e<EVENTS; e++) {
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config[e];
+        attr.disabled = (e == 0);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        fd[e] = syscall(__NR_perf_event_open, &attr, 0, -1, (e == 0) ? -1 : fd[0], 0);
+        if (fd[e] < 0) {
+            release();
+            return false;
+        }
+    }
+    memset(kernels, 0, sizeof(kernels));
+    ioctl(fd[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(fd[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    opened = true;
+    return true;
+}
+
+//************************************************************************** close()
+/**
+ * Stop counting, release this thread's counters, and keep other threads
+ * from opening any more.  For the thread that called open().
+ */
+void
+perfcounters::close() {
+    release();
+    wanted = false;
+}
+
+//************************************************************************** release()
+/**
+ * Stop counting and release this thread's counters.
+ */
+void
+perfcounters::release() {
+    for (int e=0; e<EVENTS; e++) {
+        if (fd[e] >= 0) ::close(fd[e]);
+        fd[e] = -1;
+    }
+    opened = false;
+}
+
+//************************************************************************** read(unsigned long long *)
+/**
+ * Read the whole group at once.
+ * \param values (output) the counts, in the order of enum event.
+ */
+void
+perfcounters::read(unsigned long long *values) {
+    unsigned long long buf[1 + EVENTS];
+    if (::read(fd[0], buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+        memset(values, 0, EVENTS * sizeof(*values));
+        return;
+    }
+    memcpy(values, &buf[1], EVENTS * sizeof(*values));
+}
+
+//************************************************************************** report(std::ostream &)
+/**
+ * Write the counts for each kernel as a line of JSON: the counts per call,
+ * and the totals estimated for all the calls, over this thread and the
+ * threads that have ended.  Then start the totals again.  Threads still
+ * running are left out.
+ * \param out where to write.
+ */
+void
+perfcounters::report(std::ostream &out) {
+    static const char *events[EVENTS] = {"cycles", "instructions", "cache_misses",
+        "branch_misses"};
+    int k, e;
+
+    if (!wanted) return;
+    merge();
+    pthread_mutex_lock(&lock);
+    for (k=0; k<KERNELS; k++) {
+        counts &c = merged[k];
+        if (c.measured == 0) continue;
+        double scale = (double)c.calls / c.measured;
+        out << fixed << setprecision(1)
+            << "{\"perf\":\"" << names[k] << "\""
+            << ",\"calls\":" << c.calls
+            << ",\"measured\":" << c.measured;
+        for (e=0; e<EVENTS; e++) {
+            out << ",\"" << events[e] << "_per_call\":" << (double)c.total[e] / c.measured;
+        }
+        for (e=0; e<EVENTS; e++) {
+            out << ",\"" << events[e] << "\":" << setprecision(0) << c.total[e] * scale;
+        }
+        out << setprecision(3)
+            << ",\"ipc\":" << (c.total[CYCLES] ? (double)c.total[INSTRUCTIONS] / c.total[CYCLES] : 0)
+            << "}" << endl;
+        c.calls = c.measured = 0;
+        memset(c.total, 0, sizeof(c.total));
+    }
+    pthread_mutex_unlock(&lock);
+}
+
+#endif
@@ -0,0 +1,110 @@
+/***************************************************************************
+                          perfcounters.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class perfcounters.
+ *
+ * None of this is compiled unless PERFCOUNTERS is defined in qval.h.
+ */
+
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include "qval.h"
+
+#ifdef PERFCOUNTERS
+
+#include <pthread.h>
+
+/// The hardware performance counters, read around the hot parts of the code.
+
+/// Linux perf_event_open() gives a group of four counters: cycles,
+/// instructions, cache misses and branch misses, counted in user mode only.
+/// Each kernel (a part of the code worth measuring) has a begin() and an
+/// end() around it, and the counts in between are added to its totals.
+/// Reading the counters takes a system call, which would swamp something as
+/// quick as canonical(), so the quick kernels are measured only on some of
+/// their calls, and the totals are scaled up.
+///
+/// A group counts only the thread that opened it, so each thread has a
+/// group and totals of its own.  The thread that calls open() gets one at
+/// once; any other opens one the first time it begins a kernel, so the
+/// workers of eval and serve and the ponderer are counted without doing
+/// anything about it.  When a thread ends, its totals are added to the
+/// process's, and report() adds those of the thread calling it.
+
+class perfcounters {
+public:
+    /// The parts of the code that are measured.
+    enum kernel {SEQUENCE, CANONICAL, STRATEGIC, OUTPUT, KERNELS};
+    /// The counters.
+    enum event {CYCLES, INSTRUCTIONS, CACHEMISSES, BRANCHMISSES, EVENTS};
+    /// Open the counters, for this thread and for those to come.
+    static bool open();
+    /// Close this thread's, and let no more be opened.
+    static void close();
+    /// Start a kernel.
+    static void begin(kernel k) {
+        if (!opened && !attach()) return;
+        counts &c = kernels[k];
+        if (c.depth++ == 0 && ++c.calls % every[k] == 0) {
+            read(c.start);
+            c.measuring = true;
+        }
+    }
+    /// Finish a kernel.
+    static void end(kernel k) {
+        counts &c = kernels[k];
+        if (opened && --c.depth == 0 && c.measuring) {
+            unsigned long long now[EVENTS];
+            read(now);
+            for (int e=0; e<EVENTS; e++) c.total[e] += now[e] - c.start[e];
+            c.measured++;
+            c.measuring = false;
+        }
+    }
+    /// Write the totals, one line of JSON for each kernel, and start again.
+    static void report(std::ostream &out);
+private:
+    /// What has been counted for a kernel.
+    struct counts {
+        long long calls;        ///< Times it was run.
+        long long measured;     ///< Times it was measured.
+        unsigned long long total[EVENTS];   ///< Counts over the measured runs.
+        unsigned long long start[EVENTS];   ///< Counts when the run began.
+        int depth;              ///< Calls in progress (for recursion).
+        bool measuring;         ///< Whether this run is being measured.
+    };
+    static const char *names[KERNELS];  ///< What the kernels are called.
+    static const int every[KERNELS];    ///< One call of each in this many is measured.
+    static __thread counts kernels[KERNELS];    ///< This thread's totals.
+    static __thread int fd[EVENTS];     ///< Its counters; the first leads the group.
+    static __thread bool opened;        ///< Whether it has them.
+    static __thread bool tried;         ///< Whether it has tried to open them.
+    static counts merged[KERNELS];      ///< The totals of threads that have ended.
+    static pthread_mutex_t lock;        ///< Guards them.
+    static pthread_key_t leaving;       ///< Calls detach() as a thread ends.
+    static bool wanted;                 ///< Whether threads are to open counters.
+    static bool group();
+    static bool attach();
+    static void detach(void *unused);
+    static void release();
+    static void merge();
+    static void read(unsigned long long *values);
+};
+
+#endif
+#endif
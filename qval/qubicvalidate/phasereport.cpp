@@ -0,0 +1,149 @@
+/***************************************************************************
+                          phasereport.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class phasereport.
+ */
+
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "phasereport.h"
+
+phasereport::phasereport() {
+    begin(0);
+}
+
+//************************************************************************** begin(int)
+/**
+ * Start the clocks for a phase, and forget any earlier one.
+ * \param which the phase number.
+ */
+void
+phasereport::begin(int which) {
+    phase = which;
+    wallstart = timer::now();
+    cpustart = cpu();
+    initns = searchns = canonns = ions = 0;
+    positionsin = positionsout = edges = canonicals = 0;
+    nstreams = 0;
+}
+
+//************************************************************************** merge(const phasereport &)
+/**
+ * Add in what a board kept in a report of its own, while it worked on a
+ * thread beside others.  Its files and clocks are not used.
+ * \param other the board's report.
+ */
+void
+phasereport::merge(const phasereport &other) {
+    searchns += other.searchns;
+    canonns += other.canonns;
+    canonicals += other.canonicals;
+    ions += other.ions;
+    positionsin += other.positionsin;
+    positionsout += other.positionsout;
+    edges += other.edges;
+}
+
+//************************************************************************** input(const char *)
+/**
+ * Note a file the phase reads.  It is read all the way through, so its size
+ * is the number of bytes read.
+ * \param name the name of the file.
+ */
+void
+phasereport::input(const char *name) {
+    add(name, true);
+}
+
+//************************************************************************** output(const char *)
+/**
+ * Note a file the phase writes.  What it adds is the growth of the file.
+ * \param name the name of the file.
+ */
+void
+phasereport::output(const char *name) {
+    add(name, false);
+}
+
+void
+phasereport::add(const char *name, bool in) {
+    if (nstreams == MAXSTREAMS) return;
+    streams[nstreams].name = name;
+    streams[nstreams].in = in;
+    streams[nstreams].start = in ? 0 : size(name);
+    nstreams++;
+}
+
+//************************************************************************** size(const char *)
+/// The size of a file, or 0 if there's no such file.
+off_t
+phasereport::size(const char *name) {
+    struct stat st;
+    if (stat(name, &st) < 0) return 0;
+    return st.st_size;
+}
+
+//************************************************************************** cpu()
+/// The CPU time used by the process so far, user and system, in seconds.
+double
+phasereport::cpu() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec
+        + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+//************************************************************************** end(std::ostream &)
+/**
+ * Write the summary of the phase as one line of JSON.  The files should have
+ * been closed, so that all they got is counted.
+ * \param out where to write it.
+ */
+void
+phasereport::end(std::ostream &out) {
+    struct rusage ru;
+    double wall = (timer::now() - wallstart) / 1e9;
+    double used = cpu() - cpustart;
+    int i;
+
+    getrusage(RUSAGE_SELF, &ru);
+    // canonns is estimated, and could come to a little more than the search took.
+    out << fixed << setprecision(3)
+        << "{\"phase\":" << phase
+        << ",\"wall_s\":" << wall
+        << ",\"cpu_s\":" << used
+        << ",\"positions_in\":" << positionsin
+        << ",\"positions_out\":" << positionsout
+        << ",\"edges\":" << edges
+        << ",\"in_per_s\":" << (wall > 0 ? positionsin / wall : 0)
+        << ",\"out_per_s\":" << (wall > 0 ? positionsout / wall : 0)
+        << ",\"peak_rss_kb\":" << ru.ru_maxrss
+        << ",\"init_s\":" << initns / 1e9
+        << ",\"search_s\":" << (searchns > 0 ? searchns : 0) / 1e9
+        << ",\"canonicals\":" << canonicals
+        << ",\"canonical_s\":" << canonns / 1e9
+        << ",\"io_s\":" << ions / 1e9
+        << ",\"streams\":[";
+    for (i=0; i<nstreams; i++) {
+        out << (i ? "," : "") << "{\"name\":\"" << streams[i].name << "\""
+            << ",\"dir\":\"" << (streams[i].in ? "in" : "out") << "\""
+            << ",\"bytes\":" << (long long)(size(streams[i].name) - streams[i].start) << "}";
+    }
+    out << "]}" << endl;
+}
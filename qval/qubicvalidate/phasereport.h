@@ -0,0 +1,78 @@
+/***************************************************************************
+                          phasereport.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class phasereport.
+ */
+
+#ifndef PHASEREPORT_H
+#define PHASEREPORT_H
+
+#include <sys/types.h>
+
+#include "qval.h"
+#include "timer.h"
+
+/// Where the time of a phase went, and how much it read and wrote.
+
+/// There's one of these, the global \a report (see qval.h).  main() starts
+/// it before the initializations and names the files the phase uses; the
+/// board adds in the time it spends searching, making canonical forms and
+/// writing.  Those times don't overlap: the search's own time leaves out the
+/// canonical forms and writing done in it.  At the end of the phase it is
+/// written out as one line of JSON, for whatever schedules the runs.
+
+class phasereport {
+public:
+    phasereport();
+    /// Start the clocks for a phase.
+    void begin(int phase);
+    /// Note a file the phase reads.
+    void input(const char *name);
+    /// Note a file the phase writes (or appends to).
+    void output(const char *name);
+    /// Add in the counts and times of a board's own report.
+    void merge(const phasereport &other);
+    /// Write the summary.
+    void end(std::ostream &out);
+    long long initns;       ///< Time building the isos, wins and dictionary.
+    long long searchns;     ///< Time in board::sequence(), less canonns and ions spent in it.
+    static const int SAMPLE = 16;   ///< Calls of board::canonical() per one timed.
+    long long canonns;      ///< Time in board::canonical(), estimated from a sample.
+    long canonicals;        ///< Calls of board::canonical().
+    long long ions;         ///< Time reading inputs and writing positions and trees.
+    long positionsin;       ///< Positions read, or taken from the dictionary.
+    long positionsout;      ///< Positions written.
+    long edges;             ///< Lines written to the tree.
+private:
+    static const int MAXSTREAMS = 8;
+    /// A file used by the phase.
+    struct stream {
+        const char *name;   ///< Its name.
+        off_t start;        ///< Its size at the start.
+        bool in;            ///< Whether it's read, rather than written.
+    };
+    int phase;              ///< Which phase this is.
+    long long wallstart;    ///< When it started.
+    double cpustart;        ///< The CPU time used by then, in seconds.
+    stream streams[MAXSTREAMS];
+    int nstreams;
+    void add(const char *name, bool in);
+    static off_t size(const char *name);
+    static double cpu();
+};
+
+#endif
@@ -0,0 +1,176 @@
+/***************************************************************************
+                          playbook.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class playbook.
+ */
+
+#include <stdio.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "playbook.h"
+
+static const char bookmagic[8] = {'Q','U','B','B','O','K','0','1'};
+
+playbook::playbook() {
+    slots = 0;
+    count = 0;
+    table = NULL;
+    map = NULL;
+    mapsize = 0;
+}
+
+//****************************************************************** open(const char *)
+/**
+ * Map a compiled playbook, read-only.
+ * \param path the name of the file.
+ * \return true if all went well.
+ */
+bool
+playbook::open(const char *path) {
+    struct stat st;
+    header *h;
+    int fd;
+
+    close();
+    fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(header)) {
+        ::close(fd);
+        return false;
+    }
+    map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        map = NULL;
+        return false;
+    }
+    mapsize = st.st_size;
+    h = (header *)map;
+    if (memcmp(h->magic, bookmagic, sizeof(bookmagic)) != 0
+            || h->slots == 0 || (h->slots & (h->slots - 1)) != 0
+            || mapsize < sizeof(header) + (size_t)h->slots * sizeof(entry)) {
+        cerr << path << " is not a playbook" << endl;
+        close();
+        return false;
+    }
+    slots = h->slots;
+    count = h->count;
+    table = (entry *)(h + 1);
+    return true;
+}
+
+//****************************************************************** close()
+/**
+ * Release the playbook, whether mapped or being compiled.
+ */
+void
+playbook::close() {
+    if (map) {
+        munmap(map, mapsize);
+    } else {
+        delete[] table;
+    }
+    map = NULL;
+    mapsize = 0;
+    table = NULL;
+    slots = 0;
+    count = 0;
+}
+
+//****************************************************************** add(const poskey &, int, int)
+/**
+ * Add a canonical position and its move, while compiling.  The first move
+ * given for a position is the one kept.
+ * \param key the position.
+ * \param move its canonical move.
+ * \param plies how many plies the move wins in, or 0 if that isn't known.
+ * \return false if the position already had a move.
+ */
+bool
+playbook::add(const poskey &key, int move, int plies) {
+    unsigned int i;
+
+    Assert<bad_arg>(NASSERT || (!map && move >= 0 && move < 64));
+    if (2 * (count + 1) > slots) grow();
+    i = key.hash() & (slots - 1);
+    while (table[i].move >= 0) {
+        if (table[i].xs == key.xs && table[i].os == key.os) return false;
+        i = (i + 1) & (slots - 1);
+    }
+    table[i].xs = key.xs;
+    table[i].os = key.os;
+    table[i].move = move;
+    table[i].plies = plies;
+    count++;
+    return true;
+}
+
+//****************************************************************** grow()
+/**
+ * Double the table being compiled (or make the first one), keeping it at most
+ * half full.
+ */
+void
+playbook::grow() {
+    unsigned int oldslots = slots, i, j;
+    entry *old = table;
+
+    slots = oldslots ? 2 * oldslots : 1 << 16;
+    table = new entry[slots];
+    for (i=0; i<slots; i++) {
+        table[i].xs = table[i].os = 0;
+        table[i].move = -1;
+        table[i].plies = 0;
+    }
+    for (i=0; i<oldslots; i++) {
+        if (old[i].move < 0) continue;
+        poskey key;
+        key.xs = old[i].xs;
+        key.os = old[i].os;
+        j = key.hash() & (slots - 1);
+        while (table[j].move >= 0) j = (j + 1) & (slots - 1);
+        table[j] = old[i];
+    }
+    delete[] old;
+}
+
+//****************************************************************** save(const char *)
+/**
+ * Write the compiled playbook.
+ * \param path the name of the file.
+ * \return true if all went well.
+ */
+bool
+playbook::save(const char *path) {
+    header h;
+    FILE *f;
+    bool ok;
+
+    if (!table) grow();
+    memcpy(h.magic, bookmagic, sizeof(h.magic));
+    h.slots = slots;
+    h.count = count;
+    f = fopen(path, "wb");
+    if (!f) return false;
+    ok = fwrite(&h, sizeof(h), 1, f) == 1
+        && fwrite(table, sizeof(entry), slots, f) == slots;
+    return (fclose(f) == 0) && ok;
+}
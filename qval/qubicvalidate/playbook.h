@@ -0,0 +1,80 @@
+/***************************************************************************
+                          playbook.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class playbook.
+ */
+
+#ifndef PLAYBOOK_H
+#define PLAYBOOK_H
+
+#include "qval.h"
+#include "poskey.h"
+
+/// The winning move for every position of the validated tree, ready to play.
+
+/// qubiccompile reads the tree files that validation writes, and keeps the
+/// move the 1st player made in each position where it was the 1st player's
+/// turn.  It writes them to a file as an open-addressed hash table on the
+/// canonical position, at most half full, so that a lookup is one probe or
+/// very nearly.  makemove() maps the file and asks it before the dictionary
+/// and long before a search.  Moves are kept in canonical coordinates.
+/// qubicproof -d writes the same kind of file from its distance pass, with
+/// the fastest win in each position and how many plies it takes.
+
+class playbook {
+public:
+    /// A position and its move.
+    struct entry {
+        unsigned long long xs;  ///< Key: cells of the 1st player.
+        unsigned long long os;  ///< Key: cells of the 2nd player.
+        int move;               ///< Canonical move to make; -1 for an empty slot.
+        int plies;              ///< Plies to the win, if known; 0 if not.
+    };
+    playbook();
+    ~playbook() {close();}
+    bool open(const char *path);    //!< \brief Map a compiled playbook.
+    void close();                   //!< \brief Release it.
+    /// Look up a canonical position; returns its canonical move, or -1.
+    int find(const poskey &key) const {
+        if (!table) return -1;
+        unsigned int i = key.hash() & (slots - 1);
+        while (table[i].move >= 0) {
+            if (table[i].xs == key.xs && table[i].os == key.os) return table[i].move;
+            i = (i + 1) & (slots - 1);
+        }
+        return -1;
+    }
+    /// Add a position while compiling; false if it already has a move.
+    bool add(const poskey &key, int move, int plies = 0);
+    /// Write the compiled playbook.
+    bool save(const char *path);
+    unsigned int count;     //!< Positions in the book.
+private:
+    /// The beginning of the file.
+    struct header {
+        char magic[8];          ///< Identifies the file.
+        unsigned int slots;     ///< Size of the table; a power of 2.
+        unsigned int count;     ///< Slots in use.
+    };
+    unsigned int slots;     ///< Size of the table.
+    entry *table;           ///< The table, mapped or being compiled.
+    void *map;              ///< Where the file is mapped, if it is.
+    size_t mapsize;         ///< How much is mapped.
+    void grow();
+};
+
+#endif
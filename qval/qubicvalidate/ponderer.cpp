@@ -0,0 +1,181 @@
+/***************************************************************************
+                          ponderer.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class ponderer.
+ */
+
+#include "ponderer.h"
+#include "evaluator.h"
+
+ponderer::ponderer() {
+    pondered = used = 0;
+    nanswers = 0;
+    running = false;
+    halt = false;
+    thinker.account = &account;
+    thinker.halt = &halt;
+    pthread_mutex_init(&lock, NULL);
+}
+
+//************************************************************************** position(board &)
+/**
+ * The position on a board, as it stands rather than in canonical form.
+ * \param b the board.
+ * \return the position.
+ */
+poskey
+ponderer::position(board &b) {
+    poskey key;
+
+    for (int i=0; i<64; i++) {
+        if (b.val(i) == point::X) key.xs |= 1ULL << i;
+        if (b.val(i) == point::O) key.os |= 1ULL << i;
+    }
+    return key;
+}
+
+//************************************************************************** start(board &)
+/**
+ * Forget the answers to the last move, and start thinking about the replies
+ * to this one.
+ * \param b the board, with the opponent to move.
+ */
+void
+ponderer::start(board &b) {
+    stop();
+    root = position(b);
+    nanswers = 0;
+    halt = false;
+    running = pthread_create(&thread, NULL, think, this) == 0;
+}
+
+//************************************************************************** stop()
+/**
+ * Call the thread off, and add what it did to the report.  The answers it
+ * found are kept.
+ */
+void
+ponderer::stop() {
+    if (!running) return;
+    halt = true;
+    pthread_join(thread, NULL);
+    running = false;
+    report.merge(account);
+    account.begin(0);
+}
+
+//************************************************************************** find(board &)
+/**
+ * Look for the answer to the position on a board.
+ * \param b the board, with the 1st player to move.
+ * \return the move, or -1 if it wasn't found.
+ */
+int
+ponderer::find(board &b) {
+    poskey key = position(b);
+    int i, m = -1;
+
+    pthread_mutex_lock(&lock);
+    for (i=0; i<nanswers; i++) {
+        if (answers[i].key == key) {
+            m = answers[i].move;
+            used++;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&lock);
+    return m;
+}
+
+//************************************************************************** likely(int *)
+/**
+ * List the replies worth thinking about, the likeliest first.  A reply
+ * scores for every line through it the 1st player hasn't blocked, more for
+ * more of the opponent's points on it, and likewise for every line it would
+ * block, more for more of the 1st player's points.
+ * \param replies (output) the points.
+ * \return how many there are.
+ */
+int
+ponderer::likely(int *replies) {
+    int scores[64];
+    int i, k, c, l, n = 0;
+
+    thinker.setposition(root);
+    if ((c = thinker.winner()) >= 0) {
+        // The opponent must block.
+        replies[0] = c;
+        return 1;
+    }
+    for (c=0; c<64; c++) {
+        if (!thinker.isempty(c)) continue;
+        int s = 0;
+        for (i=0; (l = win::through(c, i)) >= 0; i++) {
+            int xs = 0, os = 0;
+            for (k=0; k<4; k++) {
+                int v = thinker.val(win::find(l).val(k));
+                if (v == point::X) xs++;
+                if (v == point::O) os++;
+            }
+            if (!xs) s += 1 << (3 * os);
+            if (!os) s += 1 << (3 * xs);
+        }
+        // Insertion, keeping the list in order by score.
+        for (k=n++; k>0 && scores[k-1] < s; k--) {
+            scores[k] = scores[k-1];
+            replies[k] = replies[k-1];
+        }
+        scores[k] = s;
+        replies[k] = c;
+    }
+    return n;
+}
+
+//************************************************************************** think(void *)
+/**
+ * What the thread does: answer each likely reply in turn, keeping the
+ * answers that are sure, until there are no more or it's called off.
+ * \param self the ponderer.
+ */
+void *
+ponderer::think(void *self) {
+    ponderer *p = (ponderer *)self;
+    evaluator::method how;
+    int replies[64];
+    int i, n, m;
+
+    n = p->likely(replies);
+    for (i=0; i<n && !p->halt; i++) {
+        p->thinker.setposition(p->root);
+        p->thinker.give(replies[i]);
+        poskey key = position(p->thinker);
+        try {
+            m = evaluator::choose(p->thinker, how, SLICE);
+        } catch (...) {
+            continue;
+        }
+        // A search that was called off or ran out of time is only a guess.
+        if (m < 0 || how == evaluator::GUESS) continue;
+        pthread_mutex_lock(&p->lock);
+        p->answers[p->nanswers].key = key;
+        p->answers[p->nanswers].move = m;
+        p->nanswers++;
+        p->pondered++;
+        pthread_mutex_unlock(&p->lock);
+    }
+    return NULL;
+}
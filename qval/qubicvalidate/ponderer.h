@@ -0,0 +1,79 @@
+/***************************************************************************
+                          ponderer.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class ponderer.
+ */
+
+#ifndef PONDERER_H
+#define PONDERER_H
+
+#include <pthread.h>
+
+#include "qval.h"
+#include "poskey.h"
+#include "board.h"
+#include "phasereport.h"
+
+/// Thinks about the opponent's replies while waiting for one.
+
+/// After the 1st player moves in play, start() sets a thread to work on a
+/// board of its own.  If the move threatens to win, the block is the only
+/// reply worth thinking about; otherwise every empty point is taken in turn,
+/// the ones that look best for the opponent first.  For each, the thread
+/// finds the move that would answer it, as makemove() would, and keeps it
+/// if it's sure of it.  When the opponent has moved, stop() calls the
+/// thread off, and find() gives makemove() the answer if it was found.
+///
+/// No search takes longer than SLICE, so that one hard reply doesn't keep
+/// the thread from the rest.  A search under way when stop() is called
+/// gives up within CLOCKEVERY boards.
+
+class ponderer {
+public:
+    ponderer();
+    ~ponderer() {stop();}
+    /// Start thinking about the replies to the position on \a b.
+    void start(board &b);
+    /// Stop thinking, and wait for the thread to finish.
+    void stop();
+    /// The move found for the position on \a b, or -1 if none was.
+    int find(board &b);
+    static const long long SLICE = 2000000000LL;    ///< Nanoseconds for one reply.
+    long pondered;          ///< Replies answered.
+    long used;              ///< Answers that find() gave.
+private:
+    /// A reply, and the move that answers it.
+    struct answer {
+        poskey key;             ///< The position after the reply.
+        int move;
+    };
+    board thinker;          ///< What the thread works on.
+    phasereport account;    ///< What it has done.
+    poskey root;            ///< The position with the opponent to move.
+    answer answers[64];
+    int nanswers;
+    pthread_t thread;
+    bool running;
+    volatile bool halt;     ///< Tells the thread to stop.
+    pthread_mutex_t lock;   ///< Guards the answers.
+
+    static void *think(void *self);
+    static poskey position(board &b);
+    int likely(int *replies);
+};
+
+#endif
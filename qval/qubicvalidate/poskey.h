@@ -0,0 +1,60 @@
+/***************************************************************************
+                          poskey.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class poskey.
+ */
+
+#ifndef POSKEY_H
+#define POSKEY_H
+
+/// A position packed into two 64-bit boards.
+
+/// Bit i of \a xs is set when the 1st player holds cell i, and likewise
+/// \a os for the 2nd player.  When made by board::setkey() the position is
+/// in canonical form, so the key identifies the position up to isomorphism
+/// and can be used as the key of a table.
+
+class poskey {
+public:
+    unsigned long long xs;      ///< Cells held by the 1st player.
+    unsigned long long os;      ///< Cells held by the 2nd player.
+    /// Construct the empty position.
+    poskey(): xs(0), os(0) {}
+    /// Equality test.
+    bool operator==(const poskey& other) const {
+        return xs == other.xs && os == other.os;
+    }
+    /// Inequality test.
+    bool operator!=(const poskey& other) const {
+        return xs != other.xs || os != other.os;
+    }
+    /// Ordering, for sorting.
+    bool operator<(const poskey& other) const {
+        return xs < other.xs || (xs == other.xs && os < other.os);
+    }
+    /// A well-mixed hash of the two boards.
+    unsigned long long hash() const {
+        unsigned long long h = xs * 0x9E3779B97F4A7C15ULL ^ os;
+        h ^= h >> 31;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        h ^= h >> 29;
+        h *= 0x94D049BB133111EBULL;
+        return h ^ (h >> 32);
+    }
+};
+
+#endif
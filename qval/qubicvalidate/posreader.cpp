@@ -0,0 +1,303 @@
+/***************************************************************************
+                          posreader.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class posreader.
+ */
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "posreader.h"
+
+posreader::posreader() {
+    fd = -1;
+    data = NULL;
+    size = 0;
+    chunks = NULL;
+    nchunks = 0;
+    current = index = handed = 0;
+    stopping = false;
+    nworkers = 0;
+    workers = NULL;
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&changed, NULL);
+}
+
+//************************************************************************** open(const char *, int)
+/**
+ * Map a file, cut it into chunks, and start the workers on them.
+ * \param name the name of the file.
+ * \param threads how many workers to start; with 0 the chunks are parsed as
+ *   they are reached.
+ * \return false if the file can't be read.
+ */
+bool
+posreader::open(const char *name, int threads) {
+    struct stat st;
+    const char *at, *end, *cut;
+    int i;
+
+    close();
+    fd = ::open(name, O_RDONLY);
+    if (fd < 0) return false;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        fd = -1;
+        return false;
+    }
+    size = st.st_size;
+    if (size > 0) {
+        void *m = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (m == MAP_FAILED) {
+            ::close(fd);
+            fd = -1;
+            return false;
+        }
+        madvise(m, size, MADV_SEQUENTIAL);
+        data = (const char *)m;
+    }
+
+    // Cut at the first line end after each CHUNK bytes.
+    nchunks = size / CHUNK + 1;
+    chunks = new chunk[nchunks];
+    end = data + size;
+    at = data;
+    for (i=0; at < end; i++) {
+        cut = (end - at > (long)CHUNK) ? at + CHUNK : end;
+        while (cut < end && cut[-1] != '\n') cut++;
+        chunks[i].begin = at;
+        chunks[i].end = cut;
+        chunks[i].items = NULL;
+        chunks[i].count = 0;
+        chunks[i].ready = false;
+        at = cut;
+    }
+    nchunks = i;
+    current = index = handed = 0;
+    stopping = false;
+
+    nworkers = threads;
+    if (nworkers > 0) {
+        workers = new pthread_t[nworkers];
+        for (i=0; i<nworkers; i++) {
+            if (pthread_create(&workers[i], NULL, work, this) != 0) break;
+        }
+        nworkers = i;
+    }
+    return true;
+}
+
+//************************************************************************** next(position &)
+/**
+ * Get the next position of the file, waiting for its chunk to be parsed if
+ * need be.
+ * \param p (output) the position.
+ * \return false at the end of the file.
+ */
+bool
+posreader::next(position &p) {
+    while (current < nchunks) {
+        chunk &c = chunks[current];
+        if (nworkers == 0) {
+            if (!c.ready) {
+                parsechunk(c);
+                c.ready = true;
+            }
+        } else {
+            pthread_mutex_lock(&lock);
+            while (!c.ready) pthread_cond_wait(&changed, &lock);
+            pthread_mutex_unlock(&lock);
+        }
+        if (index < c.count) {
+            p = c.items[index++];
+            return true;
+        }
+        // Done with this chunk; let the workers move on.
+        pthread_mutex_lock(&lock);
+        delete[] c.items;
+        c.items = NULL;
+        current++;
+        index = 0;
+        pthread_cond_broadcast(&changed);
+        pthread_mutex_unlock(&lock);
+    }
+    return false;
+}
+
+//************************************************************************** lines()
+/**
+ * Count the lines of the file.
+ * \return the number of line ends in it.
+ */
+long
+posreader::lines() {
+    const char *at = data, *end = data + size;
+    long n = 0;
+
+    while (at < end && (at = (const char *)memchr(at, '\n', end - at))) {
+        n++;
+        at++;
+    }
+    return n;
+}
+
+//************************************************************************** close()
+/**
+ * Stop the workers, and unmap the file.
+ */
+void
+posreader::close() {
+    int i;
+
+    if (nworkers > 0) {
+        pthread_mutex_lock(&lock);
+        stopping = true;
+        pthread_cond_broadcast(&changed);
+        pthread_mutex_unlock(&lock);
+        for (i=0; i<nworkers; i++) pthread_join(workers[i], NULL);
+    }
+    delete[] workers;
+    workers = NULL;
+    nworkers = 0;
+    for (i=0; i<nchunks; i++) delete[] chunks[i].items;
+    delete[] chunks;
+    chunks = NULL;
+    nchunks = 0;
+    if (data) munmap((void *)data, size);
+    data = NULL;
+    size = 0;
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+//************************************************************************** work(void *)
+/**
+ * The body of a worker: take the next chunk that isn't too far ahead of the
+ * reader, parse it, and say so.
+ * \param self the posreader.
+ */
+void *
+posreader::work(void *self) {
+    posreader *r = (posreader *)self;
+    int mine;
+
+    pthread_mutex_lock(&r->lock);
+    for (;;) {
+        while (!r->stopping && r->handed < r->nchunks && r->handed >= r->current + AHEAD) {
+            pthread_cond_wait(&r->changed, &r->lock);
+        }
+        if (r->stopping || r->handed >= r->nchunks) break;
+        mine = r->handed++;
+        pthread_mutex_unlock(&r->lock);
+        parsechunk(r->chunks[mine]);
+        pthread_mutex_lock(&r->lock);
+        r->chunks[mine].ready = true;
+        pthread_cond_broadcast(&r->changed);
+    }
+    pthread_mutex_unlock(&r->lock);
+    return NULL;
+}
+
+//************************************************************************** parsechunk(chunk &)
+/**
+ * Parse every line of a chunk.  The ready flag is left to the caller.
+ * \param c the chunk.
+ */
+void
+posreader::parsechunk(chunk &c) {
+    const char *at, *eol;
+    int n = 0;
+
+    for (at = c.begin; at < c.end; at++) {
+        if (*at == '\n') n++;
+    }
+    if (c.end > c.begin && c.end[-1] != '\n') n++;     // last line, unterminated
+    c.items = new position[n];
+    c.count = n;
+    for (n = 0, at = c.begin; at < c.end; at = eol + 1, n++) {
+        eol = (const char *)memchr(at, '\n', c.end - at);
+        if (!eol) eol = c.end;
+        position &p = c.items[n];
+        p.text = at;
+        p.length = eol - at;
+        p.origin = -1;
+        const char *space = (const char *)memchr(at, ' ', eol - at);
+        if (space) {
+            p.length = space - at;
+            p.origin = parseorigin(space + 1, eol);
+        }
+        p.ok = parse(at, at + p.length, p.key) && (!space || p.origin >= 0);
+    }
+}
+
+//************************************************************************** parseorigin(const char *, const char *)
+/**
+ * Parse the origin that may follow a description.
+ * \param text the digits.
+ * \param end where they end.
+ * \return the origin, or -1 if it's bad.
+ */
+int
+posreader::parseorigin(const char *text, const char *end) {
+    int origin = 0;
+
+    if (text == end) return -1;
+    for (; text < end; text++) {
+        if (*text < '0' || *text > '9' || origin > 100000) return -1;
+        origin = origin * 10 + (*text - '0');
+    }
+    return origin;
+}
+
+//************************************************************************** parse(const char *, const char *, poskey &)
+/**
+ * Parse a description like the ones board::setposition(char *) takes.
+ * \param text the description.
+ * \param end where it ends.
+ * \param key (output) the position.
+ * \return false if the description is bad.
+ */
+bool
+posreader::parse(const char *text, const char *end, poskey &key) {
+    int skip = 0, where = 0;
+
+    key.xs = key.os = 0;
+    for (; text < end; text++) {
+        switch (*text) {
+        case 'x':
+        case 'o':
+            where += skip;
+            skip = 0;
+            if (where > 63) return false;
+            if (*text == 'x') {
+                key.xs |= 1ULL << where;
+            } else {
+                key.os |= 1ULL << where;
+            }
+            where++;
+            break;
+        default:
+            if (*text < '0' || *text > '9') return false;
+            skip = skip * 10 + (*text - '0');
+            break;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+                          posreader.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class posreader.
+ */
+
+#ifndef POSREADER_H
+#define POSREADER_H
+
+#include <pthread.h>
+#include <sys/types.h>
+
+#include "qval.h"
+#include "poskey.h"
+
+/// Reads a file of position descriptions, one to a line, parsing ahead.
+
+/// The file is mapped into memory and cut into chunks at line ends.  Worker
+/// threads parse the chunks into packed positions, a few chunks ahead of
+/// where the reader has got to, so the parsing is done by the time it's
+/// wanted.  Positions come out in the order of the file.  With no workers,
+/// each chunk is parsed when it is reached.
+///
+/// A description may be followed by a space and the index of the strategic
+/// move it descends from, as board::outboard() writes it when origins are
+/// being kept.
+
+class posreader {
+public:
+    /// A parsed line.
+    struct position {
+        poskey key;         ///< The position, as described (not canonical).
+        const char *text;   ///< The line it came from, in the mapped file.
+        int length;         ///< The length of the description.
+        int origin;         ///< The strategic move it descends from, or -1.
+        bool ok;            ///< Whether the line could be parsed.
+    };
+    posreader();
+    ~posreader() {close();}
+    /// Open a file, and start parsing it with \a workers threads.
+    bool open(const char *name, int workers = 0);
+    /// Get the next position; false at the end.
+    bool next(position &p);
+    /// Count the lines in the file.
+    long lines();
+    /// Stop the workers, and release the file.
+    void close();
+    /// Parse one description.
+    static bool parse(const char *text, const char *end, poskey &key);
+private:
+    static const size_t CHUNK = 1 << 20;    ///< Bytes in a chunk, roughly.
+    static const int AHEAD = 8;             ///< Chunks parsed ahead of the reader.
+    /// A piece of the file, ending at the end of a line.
+    struct chunk {
+        const char *begin;      ///< Where it starts.
+        const char *end;        ///< Where it ends.
+        position *items;        ///< Its lines, once parsed.
+        int count;              ///< How many lines.
+        bool ready;             ///< Whether it's been parsed.
+    };
+    int fd;                 ///< The open file.
+    const char *data;       ///< Where it's mapped.
+    size_t size;            ///< Its size.
+    chunk *chunks;
+    int nchunks;
+    int current;            ///< The chunk being read.
+    int index;              ///< The next line in it.
+    int handed;             ///< Chunks given to workers so far.
+    bool stopping;          ///< Tells the workers to quit.
+    int nworkers;
+    pthread_t *workers;
+    pthread_mutex_t lock;   ///< Guards the chunks and the counts above.
+    pthread_cond_t changed; ///< Signalled when a chunk is parsed or read.
+    static void *work(void *self);
+    static void parsechunk(chunk &c);
+    static int parseorigin(const char *text, const char *end);
+};
+
+#endif
@@ -0,0 +1,184 @@
+/***************************************************************************
+                          progress.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class progress.
+ */
+
+#include <stdio.h>
+#include <sys/time.h>
+
+#include "progress.h"
+#include "timer.h"
+
+progress::progress() {
+    interval = 10;
+    statusfile = NULL;
+    shard = -1;
+    phase = 0;
+    total = done = 0;
+    nodes = 0;
+    started = currentstart = slowestns = 0;
+    current[0] = slowest[0] = '\0';
+    running = false;
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&wake, NULL);
+}
+
+//************************************************************************** begin(int, long)
+/**
+ * Start reporting on a phase, unless the interval is 0.
+ * \param which the phase number.
+ * \param count the number of positions it will work on.
+ */
+void
+progress::begin(int which, long count) {
+    phase = which;
+    total = count;
+    done = 0;
+    nodes = 0;
+    started = currentstart = timer::now();
+    slowestns = 0;
+    current[0] = slowest[0] = '\0';
+    if (interval <= 0) return;
+    running = true;
+    if (pthread_create(&thread, NULL, run, this) != 0) {
+        cerr << "Cannot start the progress reports" << endl;
+        running = false;
+    }
+}
+
+//************************************************************************** position(const char *)
+/**
+ * Note the position that is now being worked on.
+ * \param desc its description.
+ */
+void
+progress::position(const char *desc) {
+    if (!running) return;
+    pthread_mutex_lock(&lock);
+    strncpy(current, desc, sizeof(current) - 1);
+    current[sizeof(current) - 1] = '\0';
+    currentstart = timer::now();
+    pthread_mutex_unlock(&lock);
+}
+
+//************************************************************************** finished(long)
+/**
+ * Note that the current position is done.
+ * \param searched the boards searched for it.
+ */
+void
+progress::finished(long searched) {
+    if (!running) return;
+    pthread_mutex_lock(&lock);
+    long long took = timer::now() - currentstart;
+    done++;
+    nodes += searched;
+    if (took > slowestns) {
+        slowestns = took;
+        strcpy(slowest, current);
+    }
+    current[0] = '\0';
+    pthread_mutex_unlock(&lock);
+}
+
+//************************************************************************** end()
+/**
+ * Stop the reporting thread.  It makes one last report on the way out.
+ */
+void
+progress::end() {
+    if (!running) return;
+    pthread_mutex_lock(&lock);
+    running = false;
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&lock);
+    pthread_join(thread, NULL);
+}
+
+//************************************************************************** run(void *)
+/**
+ * The body of the reporting thread: report, then sleep for the interval or
+ * until told to stop.
+ * \param self the progress object.
+ */
+void *
+progress::run(void *self) {
+    progress *p = (progress *)self;
+    struct timeval now;
+    struct timespec until;
+
+    pthread_mutex_lock(&p->lock);
+    while (p->running) {
+        gettimeofday(&now, NULL);
+        until.tv_sec = now.tv_sec + p->interval;
+        until.tv_nsec = now.tv_usec * 1000;
+        pthread_cond_timedwait(&p->wake, &p->lock, &until);
+        p->report(!p->running);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+//************************************************************************** report(bool)
+/**
+ * Write a report.  Must be called with the lock held.  A status file is
+ * written under another name and then renamed, so that whoever reads it
+ * always sees a whole one.
+ * \param last whether this is the final report.
+ */
+void
+progress::report(bool last) {
+    long long now = timer::now();
+    double elapsed = (now - started) / 1e9;
+    double rate = (elapsed > 0) ? done / elapsed : 0;
+    double noderate = (elapsed > 0) ? nodes / elapsed : 0;
+    double eta = (rate > 0 && total > done) ? (total - done) / rate : 0;
+    double currents = current[0] ? (now - currentstart) / 1e9 : 0;
+
+    if (statusfile) {
+        char temp[256];
+        snprintf(temp, sizeof(temp), "%s.new", statusfile);
+        FILE *f = fopen(temp, "w");
+        if (!f) return;
+        fprintf(f, "{\"phase\":%d,\"done\":%ld,\"total\":%ld,\"elapsed_s\":%.1f,"
+                "\"rate\":%.2f,\"eta_s\":%.0f,\"nodes\":%lld,\"nodes_per_s\":%.0f,"
+                "\"slowest\":\"%s\",\"slowest_s\":%.3f,\"current\":\"%s\",\"current_s\":%.3f,"
+                "\"finished\":%s}\n",
+                phase, done, total, elapsed, rate, eta, nodes, noderate,
+                slowest, slowestns / 1e9, current, currents, last ? "true" : "false");
+        fclose(f);
+        rename(temp, statusfile);
+    } else {
+        char line[512];
+        int n = 0;
+        if (shard >= 0) n += snprintf(line + n, sizeof(line) - n, "shard %d, ", shard);
+        n += snprintf(line + n, sizeof(line) - n,
+                "phase %d: %ld/%ld (%.1f%%), %.1f/s, ETA %d:%02d:%02d, %.0f nodes/s",
+                phase, done, total, total ? 100.0 * done / total : 100.0, rate,
+                (int)eta / 3600, (int)eta / 60 % 60, (int)eta % 60, noderate);
+        if (slowest[0]) {
+            n += snprintf(line + n, sizeof(line) - n, "; slowest %s %.2fs", slowest, slowestns / 1e9);
+        }
+        if (current[0] && !last) {
+            n += snprintf(line + n, sizeof(line) - n, "; on %s %.2fs", current, currents);
+        }
+        snprintf(line + n, sizeof(line) - n, "\n");
+        // One write, so that the workers of a sharded phase don't split each other's lines.
+        fputs(line, stderr);
+    }
+}
@@ -0,0 +1,71 @@
+/***************************************************************************
+                          progress.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class progress.
+ */
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <pthread.h>
+
+#include "qval.h"
+
+/// Reports how far a phase has got, from a thread of its own.
+
+/// The phase tells it when each position starts and finishes; that is all
+/// the work done on the main thread.  Every so often the reporting thread
+/// writes a line to stderr, or else rewrites a status file (as JSON, for a
+/// job monitor to poll) giving the positions done out of the total, the
+/// rate, the time left, the rate of boards searched, the slowest position so
+/// far and the one being worked on.  A worker of a sharded phase names its
+/// shard at the start of each line, and writes each line whole, so that the
+/// lines of several workers don't run into each other.
+
+class progress {
+public:
+    progress();
+    /// Start reporting on a phase.
+    void begin(int phase, long total);
+    /// Note that work on a position has started.
+    void position(const char *desc);
+    /// Note that the position is done, and how many boards it took.
+    void finished(long nodes);
+    /// Stop reporting, with one last report.
+    void end();
+    int interval;           ///< Seconds between reports, or 0 for none.
+    const char *statusfile; ///< Where to write them, if not to stderr.
+    int shard;              ///< The shard this worker runs, or -1 if not sharded.
+private:
+    int phase;              ///< The phase being run.
+    long total;             ///< Positions in the phase.
+    long done;              ///< Positions finished.
+    long long nodes;        ///< Boards searched by them.
+    long long started;      ///< When the phase began.
+    char current[65];       ///< The position being worked on.
+    long long currentstart; ///< When it was begun.
+    char slowest[65];       ///< The position that took longest.
+    long long slowestns;    ///< How long it took.
+    bool running;           ///< Whether the reporting thread should go on.
+    pthread_t thread;
+    pthread_mutex_t lock;   ///< Guards all of the above.
+    pthread_cond_t wake;    ///< Signalled to end the thread early.
+    static void *run(void *self);
+    void report(bool last);
+};
+
+#endif
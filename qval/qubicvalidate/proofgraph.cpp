@@ -0,0 +1,797 @@
+/***************************************************************************
+                          proofgraph.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class proofgraph.
+ */
+
+#include <algorithm>
+#include <pthread.h>
+#include <stdio.h>
+
+#include "proofgraph.h"
+#include "playbook.h"
+#include "posreader.h"
+#include "iso.h"
+#include "win.h"
+
+const char *proofgraph::gapnames[GAPKINDS] = {"nomove", "missing", "owins"};
+
+unsigned long long proofgraph::lines[76];
+unsigned char proofgraph::inverse[192][64];
+int proofgraph::isos = 0;
+
+/// Orders node numbers by their keys.
+struct bykey {
+    const poskey *keys;
+    bykey(const poskey *k) {keys = k;}
+    bool operator()(unsigned int a, unsigned int b) const {return keys[a] < keys[b];}
+};
+
+proofgraph::proofgraph() {
+    nodes = 0;
+    keys = NULL;
+    flags = NULL;
+    first = NULL;
+    edges = 0;
+    to = NULL;
+    moves = NULL;
+    kinds = NULL;
+    root = NONE;
+    rejected = reached = xnodes = wins = ngaps = 0;
+    gaps = NULL;
+    plies = NULL;
+    longest = 0;
+    raw = NULL;
+    nraw = rawsize = 0;
+    keysize = 0;
+    interned = NULL;
+    internsize = 0;
+    usable = pending = NULL;
+    rfirst = rfrom = NULL;
+    work = NULL;
+    items = NULL;
+    nitems = next = 0;
+}
+
+proofgraph::~proofgraph() {
+    delete[] keys;
+    delete[] flags;
+    delete[] first;
+    delete[] to;
+    delete[] moves;
+    delete[] kinds;
+    delete[] gaps;
+    delete[] plies;
+    delete[] raw;
+    delete[] interned;
+}
+
+proofgraph::worker::worker() {
+    graph = NULL;
+    started = false;
+    found = NULL;
+    count = size = 0;
+    listed = NULL;
+    nlisted = listsize = 0;
+}
+
+proofgraph::worker::~worker() {
+    delete[] found;
+    delete[] listed;
+}
+
+//************************************************************************** worker::add(const gap &)
+/**
+ * Note a gap a thread has found.
+ * \param g the gap.
+ */
+void
+proofgraph::worker::add(const gap &g) {
+    if (count == size) {
+        size = size ? 2 * size : 64;
+        gap *more = new gap[size];
+        memcpy(more, found, count * sizeof(gap));
+        delete[] found;
+        found = more;
+    }
+    found[count++] = g;
+}
+
+//************************************************************************** worker::list(unsigned int)
+/**
+ * Note a node a thread has found.
+ * \param n the node.
+ */
+void
+proofgraph::worker::list(unsigned int n) {
+    if (nlisted == listsize) {
+        listsize = listsize ? 2 * listsize : 1024;
+        unsigned int *more = new unsigned int[listsize];
+        memcpy(more, listed, nlisted * sizeof(unsigned int));
+        delete[] listed;
+        listed = more;
+    }
+    listed[nlisted++] = n;
+}
+
+//************************************************************************** init()
+/**
+ * Make the tables of wins and of isomorphisms that positions are worked on
+ * with.
+ */
+void
+proofgraph::init() {
+    int c, i, w, k;
+
+    for (w=0; w<76; w++) lines[w] = 0;
+    for (c=0; c<64; c++) {
+        for (i=0; (w = win::through(c, i)) >= 0; i++) lines[w] |= 1ULL << c;
+    }
+    isos = iso::nextiso;
+    for (i=0; i<isos; i++) {
+        for (k=0; k<64; k++) inverse[i][iso::isos[i].val(k)] = k;
+    }
+}
+
+//************************************************************************** replies(const poskey &, poskey *, int *)
+/**
+ * Find the replies O must be answered in, in a position where O is to move
+ * and can't win at once: the block if X threatens to win, and otherwise
+ * every move.  Replies that make the same position are counted once.
+ * \param key the position.
+ * \param children (output) the positions they make, in canonical form.
+ * \param cells (output) the cells they're made in.
+ * \return how many there are.
+ */
+int
+proofgraph::replies(const poskey &key, poskey *children, int *cells) {
+    unsigned long long open;
+    poskey child;
+    int count = 0, c, i;
+
+    open = threats(key.xs, key.os);
+    if (!open) open = ~(key.xs | key.os);
+    for (; open; open &= open - 1) {
+        c = __builtin_ctzll(open);
+        child.xs = key.xs;
+        child.os = key.os | 1ULL << c;
+        child = canonical(child);
+        for (i=0; i<count && children[i] != child; i++) ;
+        if (i < count) continue;
+        children[count] = child;
+        cells[count++] = c;
+    }
+    return count;
+}
+
+//************************************************************************** fields(char *, char **)
+/**
+ * Cut a line of a tree file into its five fields: plays, from, move, result
+ * and kind.  Fields are separated by single spaces, and the starting
+ * position may be empty.
+ * \param line the line; the spaces are replaced by nulls.
+ * \param field (output) the fields.
+ * \return false if the line doesn't have five fields.
+ */
+bool
+proofgraph::fields(char *line, char **field) {
+    int n = 0;
+
+    field[n++] = line;
+    for (; *line; line++) {
+        if (*line != ' ') continue;
+        if (n == 5) return false;
+        *line = '\0';
+        field[n++] = line + 1;
+    }
+    return n == 5;
+}
+
+//************************************************************************** load(const char *)
+/**
+ * Read the edges of a tree file.  The lines that head each position checked
+ * in phase 3 are passed over; other lines that can't be read are counted.
+ * \param name the name of the file.
+ * \return false if it can't be opened.
+ */
+bool
+proofgraph::load(const char *name) {
+    char line[256];
+    char *field[5];
+    FILE *in = fopen(name, "r");
+    poskey from, to;
+    rawedge e;
+    int move;
+
+    if (!in) return false;
+    while (fgets(line, sizeof(line), in)) {
+        line[strcspn(line, "\n")] = '\0';
+        if (!fields(line, field)) continue;
+        move = atoi(field[2]);
+        if (move < 0 || move > 63
+                || !posreader::parse(field[1], field[1] + strlen(field[1]), from)
+                || !posreader::parse(field[3], field[3] + strlen(field[3]), to)) {
+            rejected++;
+            continue;
+        }
+        e.from = intern(from);
+        e.to = intern(to);
+        e.move = move;
+        e.kind = field[4][0];
+        if (nraw == rawsize) {
+            rawsize = rawsize ? 2 * rawsize : 1 << 16;
+            rawedge *more = new rawedge[rawsize];
+            memcpy(more, raw, nraw * sizeof(rawedge));
+            delete[] raw;
+            raw = more;
+        }
+        raw[nraw++] = e;
+    }
+    fclose(in);
+    return true;
+}
+
+//************************************************************************** intern(const poskey &)
+/**
+ * Find the number of a position while reading, giving it the next one if
+ * it's new.  The table is kept no more than half full.
+ * \param key the position.
+ * \return its number.
+ */
+unsigned int
+proofgraph::intern(const poskey &key) {
+    unsigned int i, n, mask;
+
+    if (2 * (nodes + 1) > internsize) {
+        unsigned int bigger = internsize ? 2 * internsize : 1 << 16;
+        delete[] interned;
+        interned = new unsigned int[bigger];
+        memset(interned, 0xff, bigger * sizeof(unsigned int));    // all NONE
+        internsize = bigger;
+        mask = bigger - 1;
+        for (n=0; n<nodes; n++) {
+            for (i=keys[n].hash() & mask; interned[i] != NONE; i = (i + 1) & mask) ;
+            interned[i] = n;
+        }
+    }
+    mask = internsize - 1;
+    for (i=key.hash() & mask; interned[i] != NONE; i = (i + 1) & mask) {
+        if (keys[interned[i]] == key) return interned[i];
+    }
+    if (nodes == keysize) {
+        keysize = keysize ? 2 * keysize : 1 << 16;
+        poskey *more = new poskey[keysize];
+        memcpy(more, keys, nodes * sizeof(poskey));
+        delete[] keys;
+        keys = more;
+    }
+    keys[nodes] = key;
+    interned[i] = nodes;
+    return nodes++;
+}
+
+//************************************************************************** build()
+/**
+ * Put the positions in order, and store the edges by the node they come
+ * from.  The same edge read twice is kept once.  Only the edges and one copy
+ * of each position are held at once, besides two numbers a node.
+ */
+void
+proofgraph::build() {
+    unsigned long i, n;
+    unsigned int k, *order, *rank;
+    poskey empty, held;
+
+    delete[] interned;
+    interned = NULL;
+    internsize = 0;
+    if (nodes < keysize) {
+        poskey *fitted = new poskey[nodes];
+        memcpy(fitted, keys, nodes * sizeof(poskey));
+        delete[] keys;
+        keys = fitted;
+        keysize = nodes;
+    }
+
+    // Where each node goes in the order of the keys.
+    order = new unsigned int[nodes];
+    for (k=0; k<nodes; k++) order[k] = k;
+    std::sort(order, order + nodes, bykey(keys));
+    rank = new unsigned int[nodes];
+    for (k=0; k<nodes; k++) rank[order[k]] = k;
+    delete[] order;
+    for (i=0; i<nraw; i++) {
+        raw[i].from = rank[raw[i].from];
+        raw[i].to = rank[raw[i].to];
+    }
+    // Move the keys into that order, a cycle of the permutation at a time.
+    for (k=0; k<nodes; k++) {
+        while (rank[k] != k) {
+            unsigned int r = rank[k];
+            held = keys[r];
+            keys[r] = keys[k];
+            keys[k] = held;
+            rank[k] = rank[r];
+            rank[r] = r;
+        }
+    }
+    delete[] rank;
+    flags = new unsigned char[nodes];
+    memset(flags, 0, nodes);
+    root = find(empty);
+
+    std::sort(raw, raw + nraw);
+    edges = std::unique(raw, raw + nraw) - raw;
+    first = new unsigned int[nodes + 1];
+    to = new unsigned int[edges];
+    moves = new unsigned char[edges];
+    kinds = new char[edges];
+    for (n=0, i=0; n<nodes; n++) {
+        first[n] = i;
+        while (i < edges && raw[i].from == n) {
+            to[i] = raw[i].to;
+            moves[i] = raw[i].move;
+            kinds[i] = raw[i].kind;
+            i++;
+        }
+    }
+    first[nodes] = i;
+    delete[] raw;
+    raw = NULL;
+    nraw = rawsize = 0;
+}
+
+//************************************************************************** find(const poskey &)
+/**
+ * Find a position among the nodes.
+ * \param key the position, in canonical form.
+ * \return its node, or NONE.
+ */
+unsigned int
+proofgraph::find(const poskey &key) const {
+    const poskey *at = std::lower_bound(keys, keys + nodes, key);
+    return (at < keys + nodes && *at == key) ? at - keys : NONE;
+}
+
+//************************************************************************** check(int)
+/**
+ * Find the nodes reachable from the empty board, and the gaps among them.
+ * If the empty board isn't in the graph, every node is checked.
+ * \param threads how many threads to check with.
+ * \return the number of gaps.
+ */
+long
+proofgraph::check(int threads) {
+    worker *crew;
+    int i;
+
+    reach();
+    if (threads < 1) threads = 1;
+    crew = new worker[threads];
+    run(crew, threads, &proofgraph::checknode, NULL, nodes);
+    ngaps = 0;
+    for (i=0; i<threads; i++) ngaps += crew[i].count;
+    delete[] gaps;
+    gaps = new gap[ngaps];
+    for (ngaps=0, i=0; i<threads; i++) {
+        memcpy(gaps + ngaps, crew[i].found, crew[i].count * sizeof(gap));
+        ngaps += crew[i].count;
+    }
+    delete[] crew;
+    std::sort(gaps, gaps + ngaps);
+    return ngaps;
+}
+
+//************************************************************************** distances(int)
+/**
+ * Find how far every node is from a forced win, in plies.  X's immediate
+ * wins are 1 ply away, and O's positions against two threats 2.  From
+ * there, the pass goes back a level at a time: an X node is one more than
+ * the first of its children to be reached, and an O node one more than the
+ * last of the replies it must be answered in.  An O node with a reply
+ * missing, or a win of its own, is never reached.  Each level is shared
+ * among the threads.
+ * \param threads how many threads to use.
+ * \return the number of nodes with a forced win.
+ */
+long
+proofgraph::distances(int threads) {
+    worker *crew;
+    unsigned int *level, *later, n, e, size;
+    long proven, count, i;
+    int t, d;
+
+    if (threads < 1) threads = 1;
+    crew = new worker[threads];
+    delete[] plies;
+    plies = new unsigned char[nodes];
+    memset(plies, UNPROVEN, nodes);
+    pending = new unsigned char[nodes];
+    memset(pending, 0, nodes);
+    usable = new unsigned char[edges];
+    memset(usable, 0, edges);
+    run(crew, threads, &proofgraph::prepare, NULL, nodes);
+
+    // Turn the edges to go back along around.
+    rfirst = new unsigned int[nodes + 1];
+    memset(rfirst, 0, (nodes + 1) * sizeof(unsigned int));
+    for (e=0; e<edges; e++) {
+        if (usable[e]) rfirst[to[e] + 1]++;
+    }
+    for (n=0; n<nodes; n++) rfirst[n + 1] += rfirst[n];
+    rfrom = new unsigned int[rfirst[nodes]];
+    for (n=0; n<nodes; n++) {
+        for (e=first[n]; e<first[n+1]; e++) {
+            if (usable[e]) rfrom[rfirst[to[e]]++] = n;
+        }
+    }
+    for (n=nodes; n>0; n--) rfirst[n] = rfirst[n - 1];
+    rfirst[0] = 0;
+    delete[] usable;
+    usable = NULL;
+
+    // The wins there's no going back from start the first two levels.
+    size = nodes ? nodes : 1;
+    level = new unsigned int[size];
+    later = new unsigned int[size];
+    for (count=0, n=0; n<nodes; n++) {
+        if (plies[n] == 1) level[count++] = n;
+    }
+    proven = 0;
+    longest = 0;
+    for (d=1; count > 0 || d <= 2; d++) {
+        if (count) longest = d;
+        proven += count;
+        i = 0;
+        if (d == 1) {
+            for (n=0; n<nodes; n++) {
+                if (plies[n] == 2) later[i++] = n;
+            }
+        }
+        for (t=0; t<threads; t++) crew[t].nlisted = 0;
+        run(crew, threads, &proofgraph::propagate, level, count);
+        for (t=0; t<threads; t++) {
+            memcpy(later + i, crew[t].listed, crew[t].nlisted * sizeof(unsigned int));
+            i += crew[t].nlisted;
+        }
+        std::swap(level, later);
+        count = i;
+    }
+    delete[] level;
+    delete[] later;
+    delete[] rfirst;
+    delete[] rfrom;
+    delete[] pending;
+    rfirst = rfrom = NULL;
+    pending = NULL;
+    delete[] crew;
+    return proven;
+}
+
+//************************************************************************** annotate(const char *)
+/**
+ * Write the fastest win of every X node that has one, with its distance, as
+ * a playbook: the move of an edge that replays, to a child one ply nearer
+ * the win.  Call distances() first.
+ * \param name the name of the file.
+ * \return false if it can't be written.
+ */
+bool
+proofgraph::annotate(const char *name) const {
+    playbook book;
+    unsigned int n, e;
+    int move;
+
+    for (n=0; n<nodes; n++) {
+        if (plies[n] == UNPROVEN || !xtomove(keys[n])) continue;
+        if (plies[n] == 1) {
+            move = __builtin_ctzll(threats(keys[n].xs, keys[n].os));
+        } else {
+            move = -1;
+            // Only a move that makes the child gets there.
+            for (e=first[n]; move<0 && e<first[n+1]; e++) {
+                if (plies[to[e]] == plies[n] - 1 && replays(n, e)) move = moves[e];
+            }
+        }
+        book.add(keys[n], move, plies[n]);
+    }
+    return book.save(name);
+}
+
+//************************************************************************** reach()
+/**
+ * Mark the nodes reachable from the empty board, and those X wins at once.
+ */
+void
+proofgraph::reach() {
+    unsigned int *queue = new unsigned int[nodes];
+    unsigned int head = 0, tail = 0, n, e;
+    unsigned long long t;
+
+    reached = xnodes = wins = 0;
+    if (root != NONE) {
+        flags[root] |= REACHED;
+        queue[tail++] = root;
+    } else {
+        for (n=0; n<nodes; n++) {
+            flags[n] |= REACHED;
+            queue[tail++] = n;
+        }
+    }
+    while (head < tail) {
+        n = queue[head++];
+        reached++;
+        const poskey &k = keys[n];
+        if (xtomove(k)) {
+            xnodes++;
+            if (threats(k.xs, k.os)) flags[n] |= XWINS;
+        } else if (!threats(k.os, k.xs)) {
+            // Two threats can't both be blocked.
+            t = threats(k.xs, k.os);
+            if (t & (t - 1)) flags[n] |= XWINS;
+        }
+        if (flags[n] & XWINS) {
+            wins++;
+            continue;
+        }
+        for (e=first[n]; e<first[n+1]; e++) {
+            if (flags[to[e]] & REACHED) continue;
+            flags[to[e]] |= REACHED;
+            queue[tail++] = to[e];
+        }
+    }
+    delete[] queue;
+}
+
+//************************************************************************** run(worker *, int, job, unsigned int *, unsigned int)
+/**
+ * Do a job to a list of nodes, on several threads.  The threads take the
+ * nodes a block at a time, and keep what they find in their workers.
+ * \param crew the workers, one for each thread.
+ * \param threads how many threads.
+ * \param what the job.
+ * \param list the nodes, or NULL for all of them.
+ * \param count how many.
+ */
+void
+proofgraph::run(worker *crew, int threads, job what, unsigned int *list, unsigned int count) {
+    int i;
+
+    work = what;
+    items = list;
+    nitems = count;
+    next = 0;
+    for (i=0; i<threads; i++) {
+        crew[i].graph = this;
+        crew[i].started = (i > 0
+                && pthread_create(&crew[i].thread, NULL, working, &crew[i]) == 0);
+    }
+    working(&crew[0]);
+    for (i=1; i<threads; i++) {
+        if (crew[i].started) pthread_join(crew[i].thread, NULL);
+    }
+}
+
+//************************************************************************** working(void *)
+/**
+ * The body of a thread: take nodes a block at a time, and do the job to
+ * each.  A thread that couldn't be started finds the work already done when
+ * it's called.
+ * \param self the thread's worker.
+ */
+void *
+proofgraph::working(void *self) {
+    worker *w = (worker *)self;
+    proofgraph *g = w->graph;
+    static const unsigned int BLOCK = 256;
+    unsigned int i, end;
+
+    while ((i = __sync_fetch_and_add(&g->next, BLOCK)) < g->nitems) {
+        end = (i + BLOCK < g->nitems) ? i + BLOCK : g->nitems;
+        for (; i<end; i++) (g->*g->work)(g->items ? g->items[i] : i, *w);
+    }
+    return NULL;
+}
+
+//************************************************************************** edgeto(unsigned int, unsigned int)
+/**
+ * Find an edge between two nodes.
+ * \param n the node it comes from.
+ * \param m the node it goes to.
+ * \return the first such edge, or NONE.
+ */
+unsigned int
+proofgraph::edgeto(unsigned int n, unsigned int m) const {
+    const unsigned int *at = std::lower_bound(to + first[n], to + first[n+1], m);
+    return (at < to + first[n+1] && *at == m) ? at - to : NONE;
+}
+
+//************************************************************************** replays(unsigned int, unsigned int)
+/**
+ * Does an edge of an X node make the position it goes to?  Not all do: an
+ * edge written for a forced reply carries X's next move, made from the
+ * position before the reply.
+ * \param n the node it comes from, with X to move.
+ * \param e the edge.
+ * \return true if X's move on the node's position makes the edge's node.
+ */
+bool
+proofgraph::replays(unsigned int n, unsigned int e) const {
+    const poskey &k = keys[n];
+    poskey child;
+
+    if ((k.xs | k.os) >> moves[e] & 1) return false;
+    child.xs = k.xs | 1ULL << moves[e];
+    child.os = k.os;
+    return canonical(child) == keys[to[e]];
+}
+
+//************************************************************************** checknode(unsigned int, worker &)
+/**
+ * Check a node, if it's reachable and X doesn't win at once, adding any gap
+ * to a thread's list.
+ * \param n the node.
+ * \param w the thread's worker.
+ */
+void
+proofgraph::checknode(unsigned int n, worker &w) {
+    const poskey &k = keys[n];
+    poskey children[64];
+    int cells[64], count, i;
+    unsigned int m, e;
+    gap g;
+
+    if (!(flags[n] & REACHED) || (flags[n] & XWINS)) return;
+    g.node = n;
+    g.move = -1;
+    if (xtomove(k)) {
+        // An edge only counts if its move makes the node it goes to.
+        for (e=first[n]; e<first[n+1]; e++) {
+            if (replays(n, e)) return;
+        }
+        g.what = NOMOVE;
+    } else if (threats(k.os, k.xs)) {
+        g.what = OWINS;
+    } else {
+        g.what = MISSING;
+        count = replies(k, children, cells);
+        for (i=0; i<count; i++) {
+            m = find(children[i]);
+            if (m != NONE && edgeto(n, m) != NONE) continue;
+            g.move = cells[i];
+            break;
+        }
+        if (g.move < 0) return;
+    }
+    w.add(g);
+}
+
+//************************************************************************** prepare(unsigned int, worker &)
+/**
+ * Set a node up for the distance pass: note it if it's won at once, and
+ * otherwise mark the edges that lead back to it.  For an X node, those are
+ * the moves that really make the position they go to; for an O node, one
+ * for each reply it must be answered in.
+ * \param n the node.
+ */
+void
+proofgraph::prepare(unsigned int n, worker &) {
+    const poskey &k = keys[n];
+    poskey children[64];
+    int cells[64], count, i;
+    unsigned long long t;
+    unsigned int m, e;
+
+    if (xtomove(k)) {
+        if (threats(k.xs, k.os)) {
+            plies[n] = 1;
+            return;
+        }
+        for (e=first[n]; e<first[n+1]; e++) usable[e] = replays(n, e);
+        return;
+    }
+    if (threats(k.os, k.xs)) return;
+    t = threats(k.xs, k.os);
+    if (t & (t - 1)) {
+        plies[n] = 2;
+        return;
+    }
+    count = replies(k, children, cells);
+    for (i=0; i<count; i++) {
+        m = find(children[i]);
+        e = (m == NONE) ? NONE : edgeto(n, m);
+        if (e == NONE) break;
+        usable[e] = 1;
+    }
+    // Waiting on a reply that isn't there, the node is never reached.
+    pending[n] = (i < count) ? UNPROVEN : count;
+}
+
+//************************************************************************** propagate(unsigned int, worker &)
+/**
+ * Go back from a node of the current level to the nodes it settles, and
+ * list them for the next.  An X node is settled by the first of its children
+ * to be reached, and an O node by the last.
+ * \param n the node.
+ * \param w the thread's worker.
+ */
+void
+proofgraph::propagate(unsigned int n, worker &w) {
+    unsigned char d = plies[n] + 1;
+    unsigned int i, p;
+
+    for (i=rfirst[n]; i<rfirst[n+1]; i++) {
+        p = rfrom[i];
+        if (xtomove(keys[p])) {
+            if (__sync_bool_compare_and_swap(&plies[p], UNPROVEN, d)) w.list(p);
+        } else if (__sync_sub_and_fetch(&pending[p], 1) == 0) {
+            plies[p] = d;
+            w.list(p);
+        }
+    }
+}
+
+//************************************************************************** canonical(const poskey &)
+/**
+ * Find the canonical form of a position.  It's the one board::canonical()
+ * picks: the view of the board, among all the isomorphisms, whose cells read
+ * highest in order, an X counting above an O and an O above an empty cell.
+ * \param key the position.
+ * \return its canonical form.
+ */
+poskey
+proofgraph::canonical(const poskey &key) {
+    poskey best, view;
+    unsigned long long b, diff;
+    int i, k, mine, theirs;
+
+    for (i=0; i<isos; i++) {
+        view.xs = view.os = 0;
+        for (b = key.xs; b; b &= b - 1) view.xs |= 1ULL << inverse[i][__builtin_ctzll(b)];
+        for (b = key.os; b; b &= b - 1) view.os |= 1ULL << inverse[i][__builtin_ctzll(b)];
+        if (i == 0) {
+            best = view;
+            continue;
+        }
+        diff = (view.xs ^ best.xs) | (view.os ^ best.os);
+        if (!diff) continue;
+        k = __builtin_ctzll(diff);
+        mine = 2 * (view.xs >> k & 1) + (view.os >> k & 1);
+        theirs = 2 * (best.xs >> k & 1) + (best.os >> k & 1);
+        if (mine > theirs) best = view;
+    }
+    return best;
+}
+
+//************************************************************************** threats(unsigned long long, unsigned long long)
+/**
+ * Find the cells where a player could win at once.
+ * \param mine the player's cells.
+ * \param theirs the other player's cells.
+ * \return the cells that would complete a line.
+ */
+unsigned long long
+proofgraph::threats(unsigned long long mine, unsigned long long theirs) {
+    unsigned long long t = 0;
+
+    for (int w=0; w<76; w++) {
+        if (!(lines[w] & theirs) && __builtin_popcountll(lines[w] & mine) == 3) {
+            t |= lines[w] & ~mine;
+        }
+    }
+    return t;
+}
@@ -0,0 +1,184 @@
+/***************************************************************************
+                          proofgraph.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class proofgraph.
+ */
+
+#ifndef PROOFGRAPH_H
+#define PROOFGRAPH_H
+
+#include <pthread.h>
+
+#include "qval.h"
+#include "poskey.h"
+
+/// The tree files of a validation, as one graph of canonical positions.
+
+/// Every line of a tree file is an edge from one canonical position to
+/// another.  load() gathers the edges of as many files as there are, keeping
+/// each position once, in a hash table, and each edge as the numbers of its
+/// two ends: 12 bytes an edge and 24 a node.  build() sorts the positions
+/// into the order of their keys, numbers the edges' ends again to match, and
+/// stores the edges in compressed sparse-row form: for node \a n, its edges
+/// are the ones from first[n] up to first[n+1], sorted by the node they go
+/// to.  That's 6 bytes an edge and 21 a node, so millions of them fit easily.
+///
+/// check() finds the nodes reachable from the empty board and looks at each
+/// of them, on several threads.  Where the 1st player (X) is to move, it must
+/// win at once or have an edge whose move really makes the node it goes to.
+/// Where the 2nd player (O) is to move, every reply must be in the graph,
+/// except that when X threatens to win, only the block counts, and when X
+/// has two threats, none do.  The ones that fall short are the gaps.
+///
+/// distances() works back from the wins, a level at a time, to find how
+/// many plies each node is from a forced win: X takes the shortest way, O
+/// holds out for the longest.  annotate() writes the fastest win of each X
+/// node as a playbook.
+///
+/// The positions are worked on as keys, not boards, so that the threads
+/// share nothing but the graph.
+
+class proofgraph {
+public:
+    /// What can be wrong with a node.
+    enum gapkind {NOMOVE, MISSING, OWINS, GAPKINDS};
+    static const char *gapnames[GAPKINDS];  ///< What the gaps are called.
+    /// Something wrong with a node.
+    struct gap {
+        unsigned int node;      ///< The node.
+        signed char move;       ///< The reply that's missing, if that's what it is.
+        unsigned char what;     ///< The kind of gap.
+        bool operator<(const gap &other) const {return node < other.node;}
+    };
+    /// Flags for the nodes.
+    enum {REACHED = 1, XWINS = 2};
+    static const unsigned int NONE = ~0U;  ///< Not a node.
+    static const unsigned char UNPROVEN = 255;  ///< No forced win is known.
+
+    proofgraph();
+    ~proofgraph();
+    /// Set up the tables; after iso::init() and win::init().
+    static void init();
+    /// Read the edges of a tree file; false if it can't be read.
+    bool load(const char *name);
+    /// Make the graph of the edges loaded.
+    void build();
+    /// Find the reachable nodes and their gaps; returns the number of gaps.
+    long check(int threads);
+    /// Find the distance of every node from a forced win; returns how many have one.
+    long distances(int threads);
+    /// Write the fastest win of each X node as a playbook; false if it can't be written.
+    bool annotate(const char *name) const;
+    /// Find a position among the nodes.
+    unsigned int find(const poskey &key) const;
+    /// Is it the 1st player's turn?
+    static bool xtomove(const poskey &key) {
+        return __builtin_popcountll(key.xs) == __builtin_popcountll(key.os);
+    }
+    /// The canonical form of a position, as board::setkey() would make it.
+    static poskey canonical(const poskey &key);
+    /// The cells where X could win at once.
+    static unsigned long long threats(unsigned long long mine, unsigned long long theirs);
+    /// The replies O must be answered in, and the cells they're made in.
+    static int replies(const poskey &key, poskey *children, int *cells);
+    /// Cut a line of a tree file into its fields.
+    static bool fields(char *line, char **field);
+
+    unsigned int nodes;     ///< Number of nodes.
+    poskey *keys;           ///< Their positions, in order (as read, until build()).
+    unsigned char *flags;   ///< Their flags.
+    unsigned int *first;    ///< Where each node's edges start.
+    unsigned long edges;    ///< Number of edges.
+    unsigned int *to;       ///< The node each edge goes to.
+    unsigned char *moves;   ///< The move it makes, in canonical coordinates.
+    char *kinds;            ///< The kind of edge, as in the tree file.
+    unsigned int root;      ///< The empty board, if it's a node.
+
+    long rejected;          ///< Lines of the tree files that couldn't be read.
+    long reached;           ///< Nodes reachable from the empty board.
+    long xnodes;            ///< Reachable nodes with X to move.
+    long wins;              ///< Reachable nodes that X wins at once.
+    long ngaps;             ///< Gaps found.
+    gap *gaps;              ///< The gaps, in order of node.
+    unsigned char *plies;   ///< Plies from each node to a forced win, or UNPROVEN.
+    int longest;            ///< The most plies any forced win takes.
+private:
+    /// An edge as it's read, by the numbers of its ends.
+    struct rawedge {
+        unsigned int from;
+        unsigned int to;
+        unsigned char move;
+        char kind;
+        bool operator<(const rawedge &other) const {
+            if (from != other.from) return from < other.from;
+            if (to != other.to) return to < other.to;
+            return move < other.move;
+        }
+        bool operator==(const rawedge &other) const {
+            return from == other.from && to == other.to && move == other.move;
+        }
+    };
+    rawedge *raw;           ///< The edges read so far.
+    unsigned long nraw;
+    unsigned long rawsize;
+    unsigned int keysize;   ///< Room in \a keys while reading.
+    unsigned int *interned; ///< While reading, a hash table of the nodes, or NONE.
+    unsigned int internsize;    ///< Its size; a power of 2.
+    unsigned char *usable;  ///< Edges the distance pass goes back along.
+    unsigned char *pending; ///< Replies each O node waits on.
+    unsigned int *rfirst;   ///< Where each node's edges in start.
+    unsigned int *rfrom;    ///< The node each edge in comes from.
+
+    static unsigned long long lines[76];        ///< The cells of each win.
+    static unsigned char inverse[192][64];      ///< Where each iso takes each cell.
+    static int isos;                            ///< How many isos.
+
+    /// A thread, and what it has found.
+    struct worker {
+        proofgraph *graph;
+        pthread_t thread;
+        bool started;
+        gap *found;             ///< Gaps.
+        long count;
+        long size;
+        unsigned int *listed;   ///< Nodes.
+        long nlisted;
+        long listsize;
+        worker();
+        ~worker();
+        void add(const gap &g);
+        void list(unsigned int n);
+    };
+    /// What the threads do with each item.
+    typedef void (proofgraph::*job)(unsigned int n, worker &w);
+    job work;               ///< What the threads are doing.
+    unsigned int *items;    ///< The nodes they do it to, or NULL for all.
+    unsigned int nitems;    ///< How many.
+    unsigned int next;      ///< The next item for a thread to take.
+
+    void reach();
+    void run(worker *crew, int threads, job what, unsigned int *list, unsigned int count);
+    static void *working(void *self);
+    unsigned int intern(const poskey &key);
+    unsigned int edgeto(unsigned int n, unsigned int m) const;
+    bool replays(unsigned int n, unsigned int e) const;
+    void checknode(unsigned int n, worker &w);
+    void prepare(unsigned int n, worker &w);
+    void propagate(unsigned int n, worker &w);
+};
+
+#endif
@@ -0,0 +1,112 @@
+/***************************************************************************
+                          qubiccompile.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Main function of qubiccompile, which makes a playbook of the tree.
+ */
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "qval.h"
+#include "iso.h"
+#include "win.h"
+#include "board.h"
+#include "strategic.h"
+#include "playbook.h"
+#include "posreader.h"
+#include "proofgraph.h"
+
+//************************************************************************** main(int, char **)
+/**
+ * Usage:
+ *     qubiccompile [-o bookfile] treefile...
+ *
+ * Read the tree files written by validation, and compile every move the 1st
+ * player made into a playbook (default playbook.bin) for qubicvalidate -b.
+ * Each move is checked by making it and comparing the result with the
+ * tree's; a move that doesn't check out is left out.
+ */
+int main(int argc, char *argv[])
+{
+    const char *bookfile = "playbook.bin";
+    int argn;
+    long edges = 0, mine = 0, rejected = 0, repeated = 0;
+    char line[256], result[65];
+    char *field[5];
+    playbook book;
+    poskey key;
+
+    for (argn=1; argn<argc && argv[argn][0] == '-'; argn++) {
+        if (strcmp(argv[argn], "-o") == 0 && argn + 1 < argc) {
+            bookfile = argv[++argn];
+        } else {
+            cerr << "usage: " << argv[0] << " [-o bookfile] treefile..." << endl;
+            exit(1);
+        }
+    }
+    if (argn == argc) {
+        cerr << "usage: " << argv[0] << " [-o bookfile] treefile..." << endl;
+        exit(1);
+    }
+    iso::init();
+    win::init();
+    strategic::init();
+    board b;
+
+    for (; argn<argc; argn++) {
+        FILE *in = fopen(argv[argn], "r");
+        if (!in) {
+            cerr << "Cannot open " << argv[argn] << endl;
+            continue;
+        }
+        while (fgets(line, sizeof(line), in)) {
+            line[strcspn(line, "\n")] = '\0';
+            if (!proofgraph::fields(line, field)) continue;     // a position heading, or blank
+            edges++;
+            if (!posreader::parse(field[1], field[1] + strlen(field[1]), key)) {
+                rejected++;
+                continue;
+            }
+            // The 1st player moves when both have played alike.
+            if (__builtin_popcountll(key.xs) != __builtin_popcountll(key.os)) continue;
+            mine++;
+            int move = atoi(field[2]);
+            if (move < 0 || move > 63 || (key.xs | key.os) >> move & 1) {
+                rejected++;
+                continue;
+            }
+            b.setposition(key);
+            b.take(move);
+            b.setstdstring(result);
+            if (strcmp(result, field[3]) != 0) {
+                rejected++;
+                continue;
+            }
+            if (!book.add(key, move)) repeated++;
+        }
+        fclose(in);
+    }
+    if (!book.save(bookfile)) {
+        cerr << "Cannot write " << bookfile << endl;
+        exit(1);
+    }
+    cout << edges << " edges, " << mine << " by the 1st player, " << rejected
+        << " rejected, " << repeated << " for positions already in the book" << endl;
+    cout << book.count << " positions in " << bookfile << endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,153 @@
+/***************************************************************************
+                          qubicproof.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Main function of qubicproof, which checks that the tree is a proof.
+ */
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "qval.h"
+#include "iso.h"
+#include "win.h"
+#include "proofgraph.h"
+#include "keysort.h"
+#include "timer.h"
+
+/// Gaps listed when they aren't written to a file.
+static const long SHOWN = 20;
+
+//************************************************************************** usage(char *)
+static void
+usage(char *me) {
+    cerr << "usage: " << me << " [-j<threads>] [-g<gapfile>] [-d<bookfile>] treefile..." << endl;
+    exit(1);
+}
+
+//************************************************************************** main(int, char **)
+/**
+ * Usage:
+ *     qubicproof [-j<threads>] [-g<gapfile>] [-d<bookfile>] treefile...
+ *
+ * Load the tree files of a validation into one graph, and check on
+ * <threads> threads (default 1) that what can be reached from the empty
+ * board is a complete strategy for the 1st player: see proofgraph.  The
+ * gaps are all written to <gapfile>, or the first few listed.  The exit
+ * status is 0 only if there are none.
+ *
+ * Then find how many plies every position is from a forced win, and with
+ * -d, write the fastest win of each to <bookfile>, for qubicvalidate -b.
+ */
+int main(int argc, char *argv[])
+{
+    int argn, threads = 1;
+    const char *gapfile = NULL;
+    const char *bookfile = NULL;
+    char *endptr;
+    char desc[72];
+    long long started;
+    long counts[proofgraph::GAPKINDS];
+    long i, proven;
+    proofgraph graph;
+
+    for (argn=1; argn<argc && argv[argn][0] == '-'; argn++) {
+        switch (argv[argn][1]) {
+        case 'j':
+                    threads = strtol(&argv[argn][2], &endptr, 10);
+                    if (argv[argn][2] == '\0' || *endptr || threads < 1) usage(argv[0]);
+                    break;
+        case 'g':
+                    if (argv[argn][2] == '\0') usage(argv[0]);
+                    gapfile = &argv[argn][2];
+                    break;
+        case 'd':
+                    if (argv[argn][2] == '\0') usage(argv[0]);
+                    bookfile = &argv[argn][2];
+                    break;
+        default:
+                    usage(argv[0]);
+        }
+    }
+    if (argn == argc) usage(argv[0]);
+    iso::init();
+    win::init();
+    proofgraph::init();
+
+    started = timer::now();
+    for (; argn<argc; argn++) {
+        if (!graph.load(argv[argn])) cerr << "Cannot open " << argv[argn] << endl;
+    }
+    graph.build();
+    cout << graph.nodes << " positions, " << graph.edges << " edges";
+    if (graph.rejected) cout << " (" << graph.rejected << " lines not understood)";
+    cout << "; loaded in " << fixed << setprecision(2) << (timer::now() - started) / 1e9
+        << " s" << endl;
+    if (graph.root == proofgraph::NONE) {
+        cout << "The empty board isn't in the tree; checking every position" << endl;
+    }
+
+    started = timer::now();
+    graph.check(threads);
+    cout << graph.reached << " reached: " << graph.xnodes << " with X to move, "
+        << graph.reached - graph.xnodes << " with O to move, " << graph.wins
+        << " won at once; checked in " << (timer::now() - started) / 1e9 << " s" << endl;
+
+    for (i=0; i<proofgraph::GAPKINDS; i++) counts[i] = 0;
+    for (i=0; i<graph.ngaps; i++) counts[graph.gaps[i].what]++;
+    cout << graph.ngaps << " gaps";
+    for (i=0; i<proofgraph::GAPKINDS; i++) {
+        cout << (i ? ", " : ": ") << counts[i] << ' ' << proofgraph::gapnames[i];
+    }
+    cout << endl;
+
+    FILE *out = gapfile ? fopen(gapfile, "w") : stdout;
+    if (!out) {
+        cerr << "Cannot write " << gapfile << endl;
+        exit(1);
+    }
+    for (i=0; i<graph.ngaps && (gapfile || i<SHOWN); i++) {
+        const proofgraph::gap &g = graph.gaps[i];
+        keysort::describe(graph.keys[g.node], desc);
+        fprintf(out, "%s %s", proofgraph::gapnames[g.what], desc);
+        if (g.move >= 0) fprintf(out, " %d", g.move);
+        fprintf(out, "\n");
+    }
+    if (gapfile) {
+        fclose(out);
+    } else if (graph.ngaps > SHOWN) {
+        cout << "..." << endl;
+    }
+
+    started = timer::now();
+    proven = graph.distances(threads);
+    cout << proven << " with a forced win, in at most " << graph.longest
+        << " plies; found in " << (timer::now() - started) / 1e9 << " s" << endl;
+    if (graph.root != proofgraph::NONE) {
+        if (graph.plies[graph.root] == proofgraph::UNPROVEN) {
+            cout << "No forced win is proved from the empty board" << endl;
+        } else {
+            cout << "The 1st player wins from the empty board in "
+                << (int)graph.plies[graph.root] << " plies" << endl;
+        }
+    }
+    if (bookfile && !graph.annotate(bookfile)) {
+        cerr << "Cannot write " << bookfile << endl;
+        exit(1);
+    }
+    return graph.ngaps ? 1 : EXIT_SUCCESS;
+}
@@ -0,0 +1,137 @@
+/***************************************************************************
+                          qubictrace.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Main function of qubictrace, which sums up the traces of searches.
+ */
+
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "qval.h"
+#include "board.h"
+#include "searchtrace.h"
+
+/// Deepest level shown separately; deeper ones are lumped in with it.
+static const int MAXLEVEL = 32;
+
+//************************************************************************** summarize(...)
+/**
+ * Sum up one traced search: the events at each level, and how many boards
+ * went into each of the moves tried at the top.
+ * \param head the description of the search.
+ * \param events its events.
+ * \param list whether to list every event as well.
+ */
+static void
+summarize(const searchtrace::header &head, const searchtrace::event *events, bool list) {
+    long counts[MAXLEVEL + 1][searchtrace::KINDS];
+    int top[64], proved[64];
+    unsigned int cost[64];
+    int tops = 0, deepest = 0;
+    unsigned int i;
+    int l, k;
+
+    memset(counts, 0, sizeof(counts));
+    cout << head.position << " move " << board::external(head.move) << ": "
+        << head.nodes << " boards, " << fixed << setprecision(3) << head.ns / 1e9 << " s, "
+        << head.events << " events";
+    if (head.kept < head.events) cout << " (last " << head.kept << " kept)";
+    cout << endl;
+
+    for (i=0; i<head.kept; i++) {
+        const searchtrace::event &e = events[i];
+        l = (e.level > MAXLEVEL) ? MAXLEVEL : e.level;
+        if (e.what < searchtrace::KINDS) counts[l][e.what]++;
+        if (l > deepest) deepest = l;
+        if (list) {
+            cout << setw(10) << e.node << setw(4) << (int)e.level << setw(4) << (int)e.plays
+                << ' ' << setw(7) << searchtrace::names[e.what] << ' '
+                << board::external(e.move) << endl;
+        }
+        // The boards that went into a top-level move are the ones up to the
+        // next top-level move.
+        if (e.level == 1 && e.what == searchtrace::FORCE && tops < 64) {
+            if (tops) cost[tops-1] = e.node - cost[tops-1];
+            top[tops] = e.move;
+            proved[tops] = 0;
+            cost[tops++] = e.node;
+        }
+        if (e.level == 1 && e.what == searchtrace::PROOF && tops) proved[tops-1] = 1;
+    }
+    if (tops) cost[tops-1] = head.nodes - cost[tops-1];
+
+    cout << " level";
+    for (k=0; k<searchtrace::KINDS; k++) cout << setw(10) << searchtrace::names[k];
+    cout << endl;
+    for (l=1; l<=deepest; l++) {
+        cout << setw(6) << l;
+        for (k=0; k<searchtrace::KINDS; k++) cout << setw(10) << counts[l][k];
+        cout << endl;
+    }
+    if (tops) {
+        cout << " top-level moves:";
+        for (k=0; k<tops; k++) {
+            cout << ' ' << board::external(top[k]) << " (" << cost[k] << " boards"
+                << (proved[k] ? ", proved" : "") << ")";
+        }
+        cout << endl;
+    }
+    cout << endl;
+}
+
+//************************************************************************** main(int, char **)
+/**
+ * Usage:
+ *     qubictrace [-e] tracefile...
+ *
+ * Sums up every search in the trace files made by qubicvalidate -T.  With
+ * -e, every event is listed too.
+ */
+int main(int argc, char *argv[])
+{
+    bool list = false;
+    int argn;
+    searchtrace::header head;
+    searchtrace::event *events;
+
+    for (argn=1; argn<argc && argv[argn][0] == '-'; argn++) {
+        if (strcmp(argv[argn], "-e") == 0) {
+            list = true;
+        } else {
+            cerr << "usage: " << argv[0] << " [-e] tracefile..." << endl;
+            exit(1);
+        }
+    }
+    if (argn == argc) {
+        cerr << "usage: " << argv[0] << " [-e] tracefile..." << endl;
+        exit(1);
+    }
+    for (; argn<argc; argn++) {
+        FILE *in = fopen(argv[argn], "rb");
+        if (!in) {
+            cerr << "Cannot open " << argv[argn] << endl;
+            continue;
+        }
+        while (searchtrace::read(in, head, events)) {
+            summarize(head, events, list);
+            delete[] events;
+        }
+        fclose(in);
+    }
+    return EXIT_SUCCESS;
+}
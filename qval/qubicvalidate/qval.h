@@ -32,7 +32,11 @@
 #define QVAL_H
 
 #define QUBICVALIDATE
+//! Define to keep winning sequences untrimmed; trim() makes the search back up
+//! and look again for shorter lines, which costs far more than it saves.
 #define NOTRIM
+//! Define to read the hardware performance counters around the hot code (Linux).
+#undef PERFCOUNTERS
 
 #ifdef QUBICVALIDATE
 #define INVERSES
@@ -49,6 +53,18 @@ using namespace std;    // for ease of use
 
 class iso;
 extern iso* canonicIso;
+class solcache;
+extern solcache *solutions;
+class playbook;
+extern playbook *book;
+class originstats;
+extern originstats *origins;
+class dependencies;
+extern dependencies *depends;
+class phasereport;
+extern phasereport report;
+class progress;
+extern progress meter;
 
 /// \brief Bad Argument Exception.
 class bad_arg {};
@@ -92,7 +108,10 @@ const bool NASSERT = false;
 #endif
 
 extern long int qubicRandom();
+extern void qubicSeed(long int seed);
 extern bool verbose;
+extern bool deterministic;
+extern bool strategicleaf;
 typedef int movenum;
 
 // strictly for the validation
@@ -101,8 +120,6 @@ extern std::ofstream checkstrategic;
 extern std::ofstream basestrategic;
 extern std::ofstream reachedstrategic;
 extern std::ofstream tree;
-
-extern std::ifstream prior;
-extern std::ifstream readstrategic;
+extern std::ofstream statsout;
 
 #endif
@@ -0,0 +1,64 @@
+/***************************************************************************
+                          searchstats.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class searchstats.
+ */
+
+#include "searchstats.h"
+
+//************************************************************************** write(std::ostream &, ...)
+/**
+ * Write the counts for one position as a line of JSON.
+ * \param out where to write.
+ * \param position the description of the position.
+ * \param index where the position was in its input.
+ * \param result what came of it: "win", "none", "strategic" or "forced".
+ * \param move the move found (external form), or -1.
+ * \param depth the length of the sequence found.
+ * \param nodes the boards searched.
+ */
+void
+searchstats::write(std::ostream &out, const char *position, int index, const char *result,
+        int move, int depth, int nodes) const {
+    int i;
+    long long total = 0;
+
+    for (i=0; i<passes; i++) total += passns[i];
+    out << "{\"position\":\"" << position << "\""
+        << ",\"index\":" << index
+        << ",\"result\":\"" << result << "\""
+        << ",\"move\":" << move
+        << ",\"depth\":" << depth
+        << ",\"nodes\":" << nodes
+        << ",\"cached\":" << (cached ? "true" : "false")
+        << ",\"passes\":" << passes
+        << ",\"ns\":" << total
+        << ",\"pass_ns\":[";
+    for (i=0; i<passes; i++) {
+        out << (i ? "," : "") << passns[i];
+    }
+    out << "],\"maxply\":" << maxply
+        << ",\"ply_nodes\":[";
+    for (i=1; i<=maxply; i++) {
+        out << (i > 1 ? "," : "") << plynodes[i];
+    }
+    out << "],\"forcing\":" << forcing
+        << ",\"replies\":" << replies
+        << ",\"cutoffs\":" << cutoffs
+        << ",\"canonicals\":" << canonicals
+        << "}" << endl;
+}
@@ -0,0 +1,67 @@
+/***************************************************************************
+                          searchstats.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class searchstats.
+ */
+
+#ifndef SEARCHSTATS_H
+#define SEARCHSTATS_H
+
+#include "qval.h"
+
+/// Counts of what one call of board::sequence() did.
+
+/// The board clears these at the start of each search, and bumps them as it
+/// goes; they are cheap enough to keep all the time.  write() puts them out
+/// as one line of JSON, so that the positions that cost the most can be
+/// found afterward.
+
+class searchstats {
+public:
+    static const int MAXPASS = 3;   ///< Deepening passes in a search.
+    int plynodes[33];       ///< Boards searched at each level; the top is 1.
+    int maxply;             ///< The deepest level reached.
+    long forcing;           ///< Forcing moves generated.
+    long replies;           ///< Forced replies made for the opponent.
+    long cutoffs;           ///< Searches cut off by the depth bound.
+    long canonicals;        ///< Positions put into canonical form.
+    int passes;             ///< Deepening passes used.
+    long long passns[MAXPASS];  ///< Time taken by each pass, in nanoseconds.
+    bool cached;            ///< The result came from the solution cache.
+
+    searchstats() {clear();}
+    /// Start counting afresh.
+    void clear() {
+        memset(plynodes, 0, sizeof(plynodes));
+        maxply = 0;
+        forcing = replies = cutoffs = canonicals = 0;
+        passes = 0;
+        memset(passns, 0, sizeof(passns));
+        cached = false;
+    }
+    /// Count a board searched at level \a ply.
+    void node(int ply) {
+        if (ply > 32) ply = 32;
+        plynodes[ply]++;
+        if (ply > maxply) maxply = ply;
+    }
+    /// Write the counts as a line of JSON.
+    void write(std::ostream &out, const char *position, int index, const char *result,
+            int move, int depth, int nodes) const;
+};
+
+#endif
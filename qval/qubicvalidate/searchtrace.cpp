@@ -0,0 +1,104 @@
+/***************************************************************************
+                          searchtrace.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class searchtrace.
+ */
+
+#include "searchtrace.h"
+
+static const char tracemagic[8] = {'Q','U','B','T','R','C','0','1'};
+
+const char *searchtrace::names[KINDS] = {"enter", "force", "reply", "cutoff", "proof", "fork"};
+
+/**
+ * Make an empty trace.
+ * \param size the number of events it can hold; rounded up to a power of 2.
+ */
+searchtrace::searchtrace(int size) {
+    unsigned int n = 1;
+    while (n < (unsigned int)size) n <<= 1;
+    ring = new event[n];
+    mask = n - 1;
+    count = 0;
+    minnodes = 0;
+    minns = 0;
+}
+
+searchtrace::~searchtrace() {
+    delete[] ring;
+}
+
+//************************************************************************** keep(FILE *, ...)
+/**
+ * Write the trace of the last search, if it looked at at least \a minnodes
+ * boards or took at least \a minns.  When the buffer has wrapped, only the
+ * latest events are written, oldest first.
+ * \param out the trace file.
+ * \param position the position searched.
+ * \param move the result of the search.
+ * \param nodes the boards it looked at.
+ * \param ns the time it took.
+ * \return true if the trace was written.
+ */
+bool
+searchtrace::keep(FILE *out, const char *position, int move, unsigned int nodes,
+        unsigned long long ns) {
+    header head;
+    unsigned long long first, i;
+
+    if (nodes < minnodes && ns < minns) return false;
+    memset(&head, 0, sizeof(head));
+    memcpy(head.magic, tracemagic, sizeof(head.magic));
+    strncpy(head.position, position, sizeof(head.position) - 1);
+    head.nodes = nodes;
+    head.ns = ns;
+    head.events = count;
+    head.kept = (count > mask) ? mask + 1 : count;
+    head.move = move;
+    fwrite(&head, sizeof(head), 1, out);
+    first = count - head.kept;
+    for (i=first; i<count; ) {
+        // Write the part up to the end of the buffer, then the rest.
+        unsigned long long at = i & mask;
+        unsigned long long n = mask + 1 - at;
+        if (n > count - i) n = count - i;
+        fwrite(&ring[at], sizeof(event), n, out);
+        i += n;
+    }
+    fflush(out);
+    return true;
+}
+
+//************************************************************************** read(FILE *, header &, event *&)
+/**
+ * Read the next search from a trace file.
+ * \param in the trace file.
+ * \param head (output) the description of the search.
+ * \param events (output) its events, in an array the caller must delete[].
+ * \return false at the end of the file, or if it's not a trace.
+ */
+bool
+searchtrace::read(FILE *in, header &head, event *&events) {
+    if (fread(&head, sizeof(head), 1, in) != 1) return false;
+    if (memcmp(head.magic, tracemagic, sizeof(tracemagic)) != 0) return false;
+    events = new event[head.kept];
+    if (fread(events, sizeof(event), head.kept, in) != head.kept) {
+        delete[] events;
+        return false;
+    }
+    return true;
+}
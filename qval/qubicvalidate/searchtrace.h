@@ -0,0 +1,88 @@
+/***************************************************************************
+                          searchtrace.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class searchtrace.
+ */
+
+#ifndef SEARCHTRACE_H
+#define SEARCHTRACE_H
+
+#include <stdio.h>
+
+#include "qval.h"
+
+/// A record of what one search did, kept in a ring buffer.
+
+/// When a board has a trace, board::sequence() records each event of the
+/// search in it: entering a board, trying a forcing move, making the forced
+/// reply, being cut off by the depth bound, and proving a win.  Events are
+/// 8 bytes, and the buffer keeps only the latest of them, so tracing costs
+/// little.  After the search, keep() writes the trace to a file only if the
+/// search took long enough to be interesting.  qubictrace reads the file.
+
+class searchtrace {
+public:
+    /// The kinds of event.
+    enum kind {ENTER, FORCE, REPLY, CUTOFF, PROOF, FORK, KINDS};
+    /// One event.
+    struct event {
+        unsigned int node;      ///< Boards searched so far.
+        unsigned char what;     ///< The kind of event.
+        unsigned char level;    ///< The level of the search.
+        signed char move;       ///< The move concerned, or -1.
+        unsigned char plays;    ///< Plays on the board.
+    };
+    /// What precedes the events of a search in the file.
+    struct header {
+        char magic[8];          ///< Identifies the file.
+        char position[68];      ///< The position searched.
+        unsigned int nodes;     ///< Boards searched.
+        unsigned long long ns;  ///< Time taken.
+        unsigned long long events;  ///< Events recorded.
+        unsigned int kept;      ///< Events in the file: the latest ones.
+        int move;               ///< The result of the search.
+    };
+    static const char *names[KINDS];    ///< What the kinds are called.
+
+    searchtrace(int size = 1 << 20);
+    ~searchtrace();
+    /// Forget the last search.
+    void clear() {count = 0;}
+    /// Record an event.
+    void record(int what, int level, int move, int plays, int node) {
+        event &e = ring[count++ & mask];
+        e.node = node;
+        e.what = what;
+        e.level = level;
+        e.move = move;
+        e.plays = plays;
+    }
+    /// Write the trace of a search to \a out if it ran long enough.
+    bool keep(FILE *out, const char *position, int move, unsigned int nodes,
+            unsigned long long ns);
+    unsigned int minnodes;  ///< Keep a search that looked at this many boards,
+    unsigned long long minns;   ///< or that took this long.
+
+    /// Read the next search from a trace file.
+    static bool read(FILE *in, header &head, event *&events);
+private:
+    event *ring;            ///< The buffer.
+    unsigned long long count;   ///< Events recorded since clear().
+    unsigned int mask;      ///< Size of the buffer less one.
+};
+
+#endif
@@ -0,0 +1,391 @@
+/***************************************************************************
+                          server.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class server.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "server.h"
+#include "evaluator.h"
+
+unsigned long long server::lines[76];
+volatile sig_atomic_t server::stopping = 0;
+
+server::server() {
+    listener = -1;
+    path = NULL;
+    wake[0] = wake[1] = -1;
+    idle = ready = last = returned = NULL;
+    sessions = requests = errors = 0;
+    limit = 0;
+    done = false;
+    pthread_mutex_init(&lock, NULL);
+    pthread_cond_init(&work, NULL);
+}
+
+//************************************************************************** open(const char *)
+/**
+ * Make the socket and listen on it.  A socket already at \a name is taken
+ * to be left over from a server that's gone, unless something answers on it;
+ * anything else there is left alone.
+ * \param name where to make the socket.
+ * \return false if it can't be made.
+ */
+bool
+server::open(const char *name) {
+    struct sockaddr_un addr;
+    struct stat st;
+
+    close();
+    if (stat(name, &st) == 0 && !S_ISSOCK(st.st_mode)) return false;
+    if (strlen(name) >= sizeof(addr.sun_path)) return false;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, name);
+    listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) return false;
+    if (connect(listener, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+        // Another server is there.
+        ::close(listener);
+        listener = -1;
+        return false;
+    }
+    unlink(name);
+    if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) < 0
+            || listen(listener, 64) < 0 || pipe(wake) < 0) {
+        ::close(listener);
+        listener = -1;
+        return false;
+    }
+    fcntl(listener, F_SETFL, O_NONBLOCK);
+    fcntl(wake[0], F_SETFL, O_NONBLOCK);
+    fcntl(wake[1], F_SETFL, O_NONBLOCK);
+    path = strdup(name);
+    return true;
+}
+
+//************************************************************************** close()
+void
+server::close() {
+    drop(idle);
+    drop(ready);
+    drop(returned);
+    idle = ready = last = returned = NULL;
+    if (listener >= 0) ::close(listener);
+    listener = -1;
+    if (path) {
+        unlink(path);
+        free(path);
+        path = NULL;
+    }
+    if (wake[0] >= 0) ::close(wake[0]);
+    if (wake[1] >= 0) ::close(wake[1]);
+    wake[0] = wake[1] = -1;
+}
+
+//************************************************************************** drop(session *)
+/**
+ * Hang up on a list of connections.
+ * \param list the first of them.
+ */
+void
+server::drop(session *list) {
+    while (list) {
+        session *s = list;
+        list = s->next;
+        ::close(s->fd);
+        delete s;
+    }
+}
+
+//************************************************************************** signalled(int)
+void
+server::signalled(int) {
+    stopping = 1;
+}
+
+//************************************************************************** run(int)
+/**
+ * Start the pool, and wait on the socket and the connections until a signal
+ * says to stop.  What the boards did is added to the global report.
+ * \param threads how many threads in the pool; at least one.
+ */
+void
+server::run(int threads) {
+    struct sigaction act;
+    int c, i, n, w, size = 0;
+    pollfd *fds = NULL;
+    session **polled = NULL;
+    session *s;
+    char junk[64];
+
+    for (w=0; w<76; w++) lines[w] = 0;
+    for (c=0; c<64; c++) {
+        for (i=0; (w = win::through(c, i)) >= 0; i++) lines[w] |= 1ULL << c;
+    }
+    // No SA_RESTART, so that a signal breaks the wait.
+    memset(&act, 0, sizeof(act));
+    act.sa_handler = signalled;
+    sigaction(SIGINT, &act, NULL);
+    sigaction(SIGTERM, &act, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    if (threads < 1) threads = 1;
+    worker *crew = new worker[threads];
+    done = false;
+    // The pool starts with the signals blocked, so that they come to this thread.
+    sigset_t signals, was;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, &was);
+    for (i=0; i<threads; i++) {
+        crew[i].srv = this;
+        crew[i].started = pthread_create(&crew[i].thread, NULL, working, &crew[i]) == 0;
+    }
+    pthread_sigmask(SIG_SETMASK, &was, NULL);
+
+    while (!stopping) {
+        for (n=0, s=idle; s; s=s->next) n++;
+        if (n + 2 > size) {
+            delete[] fds;
+            delete[] polled;
+            size = 2 * (n + 2);
+            fds = new pollfd[size];
+            polled = new session *[size];
+        }
+        fds[0].fd = listener;
+        fds[1].fd = wake[0];
+        for (n=2, s=idle; s; s=s->next, n++) {
+            fds[n].fd = s->fd;
+            polled[n] = s;
+        }
+        for (i=0; i<n; i++) {
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+        if (poll(fds, n, -1) < 0) {
+            if (errno == EINTR) continue;
+            cerr << "poll failed" << endl;
+            break;
+        }
+        // The ones that have something go to the pool; the rest wait again.
+        idle = NULL;
+        pthread_mutex_lock(&lock);
+        for (i=2; i<n; i++) {
+            s = polled[i];
+            if (fds[i].revents) {
+                s->next = NULL;
+                if (last) {
+                    last->next = s;
+                } else {
+                    ready = s;
+                }
+                last = s;
+                pthread_cond_signal(&work);
+            } else {
+                s->next = idle;
+                idle = s;
+            }
+        }
+        if (fds[1].revents) {
+            while (read(wake[0], junk, sizeof(junk)) > 0) ;
+            while ((s = returned)) {
+                returned = s->next;
+                s->next = idle;
+                idle = s;
+            }
+        }
+        pthread_mutex_unlock(&lock);
+        if (fds[0].revents) {
+            while ((c = accept(listener, NULL, NULL)) >= 0) {
+                fcntl(c, F_SETFL, O_NONBLOCK);
+                s = new session;
+                s->fd = c;
+                s->have = 0;
+                s->next = idle;
+                idle = s;
+                sessions++;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&lock);
+    done = true;
+    pthread_cond_broadcast(&work);
+    pthread_mutex_unlock(&lock);
+    for (i=0; i<threads; i++) {
+        if (crew[i].started) pthread_join(crew[i].thread, NULL);
+        report.merge(crew[i].account);
+    }
+    delete[] crew;
+    delete[] fds;
+    delete[] polled;
+}
+
+//************************************************************************** working(void *)
+/**
+ * What each thread of the pool does: take the next connection with something
+ * to read, serve it, and hand it back, or hang up if it's done with.
+ * \param self the worker.
+ */
+void *
+server::working(void *self) {
+    worker *w = (worker *)self;
+    server *srv = w->srv;
+    session *s;
+
+    for (;;) {
+        pthread_mutex_lock(&srv->lock);
+        while (!srv->ready && !srv->done) pthread_cond_wait(&srv->work, &srv->lock);
+        if (srv->done) {
+            pthread_mutex_unlock(&srv->lock);
+            return NULL;
+        }
+        s = srv->ready;
+        srv->ready = s->next;
+        if (!srv->ready) srv->last = NULL;
+        pthread_mutex_unlock(&srv->lock);
+
+        s->b.account = &w->account;
+        if (!srv->serve(s, *w)) {
+            ::close(s->fd);
+            delete s;
+            continue;
+        }
+        pthread_mutex_lock(&srv->lock);
+        s->next = srv->returned;
+        srv->returned = s;
+        pthread_mutex_unlock(&srv->lock);
+        if (write(srv->wake[1], "", 1) < 0) {
+            // The pipe is full, so the main thread is waking anyway.
+        }
+    }
+}
+
+//************************************************************************** serve(session *, worker &)
+/**
+ * Read what a connection has sent, and answer every whole line of it.
+ * \param s the connection.
+ * \param by the thread serving it.
+ * \return false if it's closed, or broken, or has sent too long a line.
+ */
+bool
+server::serve(session *s, worker &by) {
+    char reply[64];
+    char *start, *eol;
+    int n;
+
+    n = read(s->fd, s->buf + s->have, LONGEST - s->have);
+    if (n == 0) return false;
+    if (n < 0) return errno == EAGAIN || errno == EINTR;
+    s->have += n;
+    start = s->buf;
+    while ((eol = (char *)memchr(start, '\n', s->buf + s->have - start))) {
+        *eol = '\0';
+        bool ok = answer(s, by, start, reply);
+        pthread_mutex_lock(&lock);
+        requests++;
+        if (!ok) errors++;
+        pthread_mutex_unlock(&lock);
+        strcat(reply, "\n");
+        n = strlen(reply);
+        if (send(s->fd, reply, n, MSG_NOSIGNAL) != n) return false;
+        start = eol + 1;
+    }
+    s->have -= start - s->buf;
+    memmove(s->buf, start, s->have);
+    if (s->have == LONGEST) {
+        send(s->fd, "error too long\n", 15, MSG_NOSIGNAL);
+        return false;
+    }
+    return true;
+}
+
+//************************************************************************** answer(session *, worker &, char *, char *)
+/**
+ * Play out the moves of a request on the connection's board, and find the
+ * next move, for whichever player is to make it.
+ * \param s the connection.
+ * \param by the thread serving it.
+ * \param request the moves so far.
+ * \param reply (output) the move and how it was found, or the error.
+ * \return false if it's an error.
+ */
+bool
+server::answer(session *s, worker &by, char *request, char *reply) {
+    unsigned long long mine[2] = {0, 0};
+    int m, cell, w, i, plays = 0;
+    bool over = false;
+    evaluator::method how;
+    char *at, *end;
+
+    s->b.clear();
+    for (at = request; ; at = end) {
+        m = strtol(at, &end, 10);
+        if (end == at) break;
+        if (over) {
+            strcpy(reply, "error game over");
+            return false;
+        }
+        cell = board::internal(m);
+        if (m < 111 || m > 444 || m / 10 % 10 < 1 || m / 10 % 10 > 4
+                || m % 10 < 1 || m % 10 > 4 || !s->b.isempty(cell)) {
+            sprintf(reply, "error bad move %d", m);
+            return false;
+        }
+        if (plays % 2 == 0) {
+            s->b.take(cell);
+        } else {
+            s->b.give(cell);
+        }
+        mine[plays % 2] |= 1ULL << cell;
+        for (i=0; (w = win::through(cell, i)) >= 0; i++) {
+            if ((mine[plays % 2] & lines[w]) == lines[w]) over = true;
+        }
+        plays++;
+    }
+    while (*at == ' ' || *at == '\r' || *at == '\t') at++;
+    if (*at) {
+        strcpy(reply, "error not a move");
+        return false;
+    }
+    if (over) {
+        strcpy(reply, "error game over");
+        return false;
+    }
+    if (plays == 64) {
+        strcpy(reply, "error board full");
+        return false;
+    }
+    try {
+        m = evaluator::choose(s->b, how, limit, &by.deep);
+    } catch (...) {
+        strcpy(reply, "error bad position");
+        return false;
+    }
+    sprintf(reply, "%d %s", board::external(m), evaluator::methodnames[how]);
+    return true;
+}
@@ -0,0 +1,105 @@
+/***************************************************************************
+                          server.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class server.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <pthread.h>
+#include <signal.h>
+
+#include "qval.h"
+#include "board.h"
+#include "phasereport.h"
+#include "solver.h"
+
+/// Plays either side in any number of games at once, over a local socket.
+
+/// A client connects to the Unix domain socket and sends one line for each
+/// move it wants: the moves of a game so far, in external form (111 to 444),
+/// separated by spaces, starting with the 1st player's first move.  An empty
+/// line asks for the opening move.  The answer is one line: the move for
+/// whichever player is to move, and how it was found, as in eval; "win"
+/// means the move ends the game, and "guess" that nothing was proven in the
+/// time allowed.  A request that isn't a game in progress gets "error" and
+/// the reason.  Since every request carries its whole game, one
+/// connection can play any number of games, one after another or mixed.
+///
+/// The main thread waits on the socket and on every connection that has
+/// nothing to be answered.  A connection with something to read is handed
+/// to the next free thread of the pool; it reads what there is, answers each
+/// whole line on the connection's own board, and hands the connection back.
+/// The tables of isos, wins and the dictionary, the playbook and the
+/// solution cache are shared by all.  SIGINT or SIGTERM stops the server
+/// once the searches under way are done.
+
+class server {
+public:
+    server();
+    ~server() {close();}
+    /// Listen on a socket at \a path, replacing a stale one; false if it can't.
+    bool open(const char *path);
+    /// Stop listening, and remove the socket.
+    void close();
+    /// Serve on \a threads threads until told to stop.
+    void run(int threads);
+    long sessions;          ///< Connections accepted.
+    long requests;          ///< Lines answered.
+    long errors;            ///< Lines answered with an error.
+    long long limit;        ///< Nanoseconds allowed each move, or 0 for no limit.
+private:
+    static const int LONGEST = 512;     ///< Longest request; 64 moves take 256.
+    /// A connection, and the board its games are played on.
+    struct session {
+        int fd;
+        board b;
+        char buf[LONGEST];      ///< What has been read but not answered.
+        int have;
+        session *next;          ///< In whichever list it's in.
+    };
+    /// A thread of the pool.
+    struct worker {
+        server *srv;
+        pthread_t thread;
+        bool started;
+        phasereport account;    ///< What the boards did while it served them.
+        solver deep;            ///< For positions the forcing search can't win.
+        worker(): deep(&account) {}
+    };
+    int listener;           ///< The listening socket.
+    char *path;             ///< Its name.
+    int wake[2];            ///< A pipe, to wake the main thread.
+    session *idle;          ///< Connections waited on by the main thread.
+    session *ready;         ///< Connections with something to read, first to come first.
+    session *last;          ///< The last of them.
+    session *returned;      ///< Connections handed back, not yet waited on.
+    pthread_mutex_t lock;   ///< Guards the lists but idle, and the counts.
+    pthread_cond_t work;    ///< Signalled when a connection is ready, or on stopping.
+    bool done;              ///< Tells the pool to quit.
+    static unsigned long long lines[76];    ///< The cells of each win.
+    static volatile sig_atomic_t stopping;  ///< Set by the signals.
+
+    static void signalled(int);
+    static void *working(void *self);
+    bool serve(session *s, worker &by);
+    bool answer(session *s, worker &by, char *request, char *reply);
+    static void drop(session *list);
+};
+
+#endif
@@ -0,0 +1,212 @@
+/***************************************************************************
+                          shards.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class shards.
+ */
+
+#include <dirent.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "shards.h"
+#include "posreader.h"
+
+/**
+ * Make a set of shards.
+ * \param n how many.
+ */
+shards::shards(int n) {
+    count = n;
+    positions = new long[n];
+    workers = new pid_t[n];
+    failed = 0;
+    for (int i=0; i<n; i++) {
+        positions[i] = 0;
+        workers[i] = 0;
+    }
+}
+
+shards::~shards() {
+    delete[] workers;
+    delete[] positions;
+}
+
+//************************************************************************** split(const char *)
+/**
+ * Deal the positions of a file out to the shards, by the hash of each.  Each
+ * shard gets a file of the same name in its directory.
+ * \param input the name of the file.
+ * \return false if it can't be read, or a shard can't be written.
+ */
+bool
+shards::split(const char *input) {
+    posreader in;
+    posreader::position p;
+    FILE **out = new FILE *[count];
+    char name[256];
+    bool ok = true;
+    int i;
+
+    if (!in.open(input)) {
+        delete[] out;
+        return false;
+    }
+    cleanup();      // anything left by an earlier run
+    for (i=0; i<count; i++) {
+        path(i, NULL, name, sizeof(name));
+        mkdir(name, 0755);
+        path(i, input, name, sizeof(name));
+        out[i] = fopen(name, "w");
+        if (!out[i]) ok = false;
+    }
+    while (ok && in.next(p)) {
+        Assert<bad_arg>(NASSERT || p.ok);
+        i = p.key.hash() % count;
+        fwrite(p.text, 1, p.length, out[i]);
+        if (p.origin >= 0) fprintf(out[i], " %d", p.origin);
+        putc('\n', out[i]);
+        positions[i]++;
+    }
+    for (i=0; i<count; i++) {
+        if (out[i] && fclose(out[i]) != 0) ok = false;
+    }
+    delete[] out;
+    return ok;
+}
+
+//************************************************************************** start()
+/**
+ * Fork a worker for each shard, and wait for them all.
+ * \return in a worker, the number of its shard; in the parent, -1.
+ */
+int
+shards::start() {
+    int i, status;
+
+    // Don't let the workers inherit anything half-written.
+    cout.flush();
+    cerr.flush();
+    fflush(NULL);
+    for (i=0; i<count; i++) {
+        workers[i] = fork();
+        if (workers[i] == 0) return i;
+        if (workers[i] < 0) {
+            cerr << "Cannot start worker " << i << endl;
+            failed++;
+        }
+    }
+    for (i=0; i<count; i++) {
+        if (workers[i] <= 0) continue;
+        if (waitpid(workers[i], &status, 0) < 0 || !WIFEXITED(status)
+                || WEXITSTATUS(status) != 0) {
+            cerr << "Worker " << i << " failed" << endl;
+            failed++;
+        }
+    }
+    return -1;
+}
+
+//************************************************************************** enter(int)
+/**
+ * Go into the directory of a shard.
+ * \param shard which shard.
+ * \return false if it can't be done.
+ */
+bool
+shards::enter(int shard) {
+    char name[256];
+
+    path(shard, NULL, name, sizeof(name));
+    return chdir(name) == 0;
+}
+
+//************************************************************************** gather(const char *, bool)
+/**
+ * Collect a file the workers wrote: copy each shard's file of that name, in
+ * order of shard, into the file here.  A shard that wrote nothing is skipped.
+ * \param name the name of the file.
+ * \param append whether to add to the file here, or replace it.
+ * \return false if the file here can't be written.
+ */
+bool
+shards::gather(const char *name, bool append) {
+    char from[256];
+    char buf[65536];
+    size_t n;
+    FILE *out, *in;
+    bool ok = true;
+    int i;
+
+    out = fopen(name, append ? "ab" : "wb");
+    if (!out) return false;
+    for (i=0; i<count; i++) {
+        path(i, name, from, sizeof(from));
+        in = fopen(from, "rb");
+        if (!in) continue;
+        while ((n = fread(buf, 1, sizeof(buf), in)) > 0) {
+            if (fwrite(buf, 1, n, out) != n) ok = false;
+        }
+        fclose(in);
+    }
+    if (fclose(out) != 0) ok = false;
+    return ok;
+}
+
+//************************************************************************** cleanup()
+/**
+ * Remove the directories of the shards, and everything in them.
+ */
+void
+shards::cleanup() {
+    char name[256], file[512];
+    struct dirent *entry;
+    DIR *dir;
+    int i;
+
+    for (i=0; i<count; i++) {
+        path(i, NULL, name, sizeof(name));
+        dir = opendir(name);
+        if (!dir) continue;
+        while ((entry = readdir(dir))) {
+            if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0) continue;
+            path(i, entry->d_name, file, sizeof(file));
+            unlink(file);
+        }
+        closedir(dir);
+        path(i, NULL, name, sizeof(name));
+        rmdir(name);
+    }
+}
+
+//************************************************************************** path(int, const char *, char *, int)
+/**
+ * Name the directory of a shard, or a file in it.
+ * \param shard which shard.
+ * \param name the file, or NULL for the directory.
+ * \param buf (output) the path.
+ * \param size the size of \a buf.
+ */
+void
+shards::path(int shard, const char *name, char *buf, int size) {
+    if (name) {
+        snprintf(buf, size, "shard.%d/%s", shard, name);
+    } else {
+        snprintf(buf, size, "shard.%d", shard);
+    }
+}
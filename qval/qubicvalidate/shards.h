@@ -0,0 +1,64 @@
+/***************************************************************************
+                          shards.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class shards.
+ */
+
+#ifndef SHARDS_H
+#define SHARDS_H
+
+#include <sys/types.h>
+
+#include "qval.h"
+
+/// Runs a phase as several processes, each on its share of the input.
+
+/// split() deals the positions of the input out to directories shard.0,
+/// shard.1, ... by the hash of the position.  Since the positions are
+/// canonical, every copy of a position lands in the same shard, so each
+/// shard can drop its own duplicates, and the shards come out much the same
+/// size.  start() forks a worker for each shard; the worker goes into its
+/// directory and runs the phase there, writing the usual files under the
+/// usual names.  When they are all done, gather() appends what they wrote to
+/// the files of the same names here, shard by shard, and cleanup() removes
+/// the directories.  If any worker fails, nothing is gathered: the files of
+/// the others would pass for the whole output.
+
+class shards {
+public:
+    shards(int n);
+    ~shards();
+    /// Deal out the input file; false if it can't be read or a shard written.
+    bool split(const char *input);
+    /// Fork the workers.  Returns the shard number in a worker, and -1 in the
+    /// parent once all the workers have finished.
+    int start();
+    /// Go into the directory of a shard.
+    bool enter(int shard);
+    /// Add what the workers wrote to \a name to the file here.
+    bool gather(const char *name, bool append);
+    /// Remove the directories of the shards.
+    void cleanup();
+    int count;              ///< How many shards.
+    long *positions;        ///< Positions dealt to each.
+    int failed;             ///< Workers that didn't finish cleanly.
+private:
+    pid_t *workers;         ///< The workers' process ids.
+    static void path(int shard, const char *name, char *buf, int size);
+};
+
+#endif
@@ -0,0 +1,345 @@
+/***************************************************************************
+                          solcache.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class solcache.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "solcache.h"
+
+static const char solmagic[8] = {'Q','U','B','S','O','L','0','1'};
+
+solcache::solcache() {
+    fd = -1;
+    name = NULL;
+    map = NULL;
+    slots = 0;
+    hits = stores = 0;
+    pthread_mutex_init(&guard, NULL);
+}
+
+//****************************************************************** open(const char *)
+/**
+ * Open the store in the named file, creating an empty one if need be.
+ * \param path the name of the file.
+ * \return true if all went well.
+ */
+bool
+solcache::open(const char *path) {
+    struct stat st;
+
+    close();
+    fd = ::open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) return false;
+    name = strdup(path);
+    flock(fd, LOCK_EX);
+    if (fstat(fd, &st) < 0) {
+        flock(fd, LOCK_UN);
+        close();
+        return false;
+    }
+    if (st.st_size == 0) {
+        // A brand new store.
+        header h;
+        memcpy(h.magic, solmagic, sizeof(h.magic));
+        h.slots = INITIAL;
+        h.count = 0;
+        if (ftruncate(fd, sizeof(header) + (off_t)INITIAL * sizeof(solution)) < 0
+                || pwrite(fd, &h, sizeof(h), 0) != sizeof(h)) {
+            flock(fd, LOCK_UN);
+            close();
+            return false;
+        }
+    }
+    bool okay = current(LOCK_EX) && memcmp(map->magic, solmagic, sizeof(solmagic)) == 0;
+    flock(fd, LOCK_UN);
+    if (!okay) {
+        cerr << path << " is not a solution cache" << endl;
+        close();
+    }
+    return okay;
+}
+
+//****************************************************************** close()
+/**
+ * Release the store.  The contents are already on disk.
+ */
+void
+solcache::close() {
+    if (map) {
+        munmap(map, sizeof(header) + (size_t)slots * sizeof(solution));
+        map = NULL;
+    }
+    if (fd >= 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    free(name);
+    name = NULL;
+    slots = 0;
+}
+
+//****************************************************************** remap()
+/**
+ * Map the file, or map it again if another process has grown it.  Must be
+ * called with the file locked.
+ * \return true if it's mapped.
+ */
+bool
+solcache::remap() {
+    header h;
+    if (map && map->slots == slots) return true;
+    if (pread(fd, &h, sizeof(h), 0) != sizeof(h)) return false;
+    if (map) munmap(map, sizeof(header) + (size_t)slots * sizeof(solution));
+    void *where = mmap(NULL, sizeof(header) + (size_t)h.slots * sizeof(solution),
+            PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (where == MAP_FAILED) {
+        map = NULL;
+        slots = 0;
+        return false;
+    }
+    map = (header *)where;
+    slots = h.slots;
+    return true;
+}
+
+//****************************************************************** current(int)
+/**
+ * Make sure the file open is the one with the name, and map it.  If another
+ * process has replaced it, the old one has no links left; the new one is
+ * opened and locked in its place.  Must be called with the file locked.
+ * \param how the kind of lock held, LOCK_SH or LOCK_EX.
+ * \return true if it's mapped.
+ */
+bool
+solcache::current(int how) {
+    struct stat st;
+
+    while (fstat(fd, &st) == 0 && st.st_nlink == 0) {
+        int newer = ::open(name, O_RDWR);
+        if (newer < 0) return false;
+        flock(fd, LOCK_UN);
+        if (map) munmap(map, sizeof(header) + (size_t)slots * sizeof(solution));
+        map = NULL;
+        slots = 0;
+        ::close(fd);
+        fd = newer;
+        flock(fd, how);
+    }
+    return remap();
+}
+
+//****************************************************************** probe(const poskey &)
+/**
+ * Find the slot for a key: either the one holding it, or the empty one where
+ * it would go, or NULL if it isn't there and there's no room.  Must be called
+ * with the file locked.
+ */
+solcache::solution *
+solcache::probe(const poskey &key) {
+    return place(table(), slots, key);
+}
+
+//****************************************************************** place(solution *, unsigned int, const poskey &)
+/**
+ * Find the slot for a key in a table.
+ * \param t the table.
+ * \param n its size; a power of 2.
+ * \param key the position.
+ * \return the slot holding it, or the empty one where it would go, or NULL
+ * if every slot holds some other position.
+ */
+solcache::solution *
+solcache::place(solution *t, unsigned int n, const poskey &key) {
+    unsigned int mask = n - 1;
+    unsigned int i = key.hash() & mask;
+    for (unsigned int tries=0; tries<n; tries++) {
+        if (!(t[i].flags & USED) || (t[i].xs == key.xs && t[i].os == key.os)) return &t[i];
+        i = (i + 1) & mask;
+    }
+    return NULL;
+}
+
+//****************************************************************** find(const poskey &, solution &)
+/**
+ * Look up a canonical position.
+ * \param key the position.
+ * \param result (output) what was proven about it.
+ * \return true if the position is in the store.
+ */
+bool
+solcache::find(const poskey &key, solution &result) {
+    bool found = false;
+    if (fd < 0) return false;
+    pthread_mutex_lock(&guard);
+    flock(fd, LOCK_SH);
+    if (current(LOCK_SH)) {
+        solution *s = probe(key);
+        if (s && (s->flags & USED)) {
+            result = *s;
+            found = true;
+            hits++;
+        }
+    }
+    flock(fd, LOCK_UN);
+    pthread_mutex_unlock(&guard);
+    return found;
+}
+
+//****************************************************************** store(const poskey &, int, int, int)
+/**
+ * Record what was proven about a canonical position.  If the table is full
+ * and can't be grown, a new position is not recorded; one slot is always
+ * left empty, so that a search for a position that isn't there ends.
+ * \param key the position.
+ * \param move the canonical move that starts the win, or -1 if there's none.
+ * \param depth the length of the winning sequence.
+ * \param nodes the number of positions searched.
+ * \param flags how the result was found.
+ */
+void
+solcache::store(const poskey &key, int move, int depth, int nodes, int flags) {
+    if (fd < 0) return;
+    pthread_mutex_lock(&guard);
+    flock(fd, LOCK_EX);
+    if (current(LOCK_EX)) {
+        if ((map->count + 1) * 4 > slots * 3) grow();
+        solution *s = probe(key);
+        if (s && !(s->flags & USED) && map->count + 1 >= slots) s = NULL;
+        if (s) {
+            if (!(s->flags & USED)) map->count++;
+            s->xs = key.xs;
+            s->os = key.os;
+            s->nodes = nodes;
+            s->move = move;
+            s->depth = depth;
+            s->spare = 0;
+            s->flags = USED | flags;
+            stores++;
+        }
+    }
+    flock(fd, LOCK_UN);
+    pthread_mutex_unlock(&guard);
+}
+
+//****************************************************************** sweep(bool (*)(const solution &, void *), void *)
+/**
+ * Forget some of the results, by building a table of the rest.
+ * \param doomed the test: true for a result to be forgotten.
+ * \param arg passed to the test.
+ * \return the number forgotten, or -1 if the new table couldn't be made.
+ */
+long
+solcache::sweep(bool (*doomed)(const solution &s, void *arg), void *arg) {
+    long gone = -1;
+
+    if (fd < 0) return 0;
+    pthread_mutex_lock(&guard);
+    flock(fd, LOCK_EX);
+    if (current(LOCK_EX)) gone = rebuild(slots, doomed, arg);
+    flock(fd, LOCK_UN);
+    pthread_mutex_unlock(&guard);
+    return gone;
+}
+
+//****************************************************************** grow()
+/**
+ * Double the size of the table.  If it can't be done, the table stays as it
+ * is, and fills up further, until store() turns new positions away.  Must be
+ * called with the file locked exclusively.
+ */
+void
+solcache::grow() {
+    rebuild(slots * 2, NULL, NULL);
+}
+
+//****************************************************************** rebuild(unsigned int, bool (*)(const solution &, void *), void *)
+/**
+ * Put the results into a new table, in a file beside this one, and rename
+ * it over this one.  Until the rename, this file is untouched; after it,
+ * the new file is the one open, locked exclusively in its turn.  Must be
+ * called with the file locked exclusively.
+ * \param newslots the size of the new table; a power of 2.
+ * \param doomed the test for results to leave out, or NULL to keep them all.
+ * \param arg passed to the test.
+ * \return the number left out, or -1 if the new table couldn't be made.
+ */
+long
+solcache::rebuild(unsigned int newslots, bool (*doomed)(const solution &s, void *arg), void *arg) {
+    size_t size = sizeof(header) + (size_t)newslots * sizeof(solution);
+    size_t length = strlen(name) + 32;
+    char *temp = new char[length];
+    solution *t = table();
+    long gone = 0;
+    int newer;
+
+    snprintf(temp, length, "%s.%d.new", name, (int)getpid());
+    newer = ::open(temp, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    void *where = MAP_FAILED;
+    if (newer >= 0 && ftruncate(newer, size) == 0) {
+        where = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, newer, 0);
+    }
+    if (where == MAP_FAILED) {
+        if (newer >= 0) ::close(newer);
+        unlink(temp);
+        delete[] temp;
+        return -1;
+    }
+    header *h = (header *)where;
+    solution *fresh = (solution *)(h + 1);
+    memcpy(h->magic, solmagic, sizeof(h->magic));
+    h->slots = newslots;
+    h->count = 0;
+    for (unsigned int i=0; i<slots; i++) {
+        if (!(t[i].flags & USED)) continue;
+        if (doomed && doomed(t[i], arg)) {
+            gone++;
+            continue;
+        }
+        poskey k;
+        k.xs = t[i].xs;
+        k.os = t[i].os;
+        *place(fresh, newslots, k) = t[i];
+        h->count++;
+    }
+    bool ok = msync(where, size, MS_SYNC) == 0;
+    munmap(where, size);
+    if (!ok || fsync(newer) != 0 || rename(temp, name) != 0) {
+        ::close(newer);
+        unlink(temp);
+        delete[] temp;
+        return -1;
+    }
+    delete[] temp;
+
+    // Others may open the new file from now on, and wait on this one.
+    flock(newer, LOCK_EX);
+    munmap(map, sizeof(header) + (size_t)slots * sizeof(solution));
+    map = NULL;
+    slots = 0;
+    flock(fd, LOCK_UN);
+    ::close(fd);
+    fd = newer;
+    remap();
+    return gone;
+}
@@ -0,0 +1,95 @@
+/***************************************************************************
+                          solcache.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class solcache.
+ */
+
+#ifndef SOLCACHE_H
+#define SOLCACHE_H
+
+#include <pthread.h>
+
+#include "qval.h"
+#include "poskey.h"
+
+/// A persistent store of the results of board::sequence().
+
+/// The store is a file holding an open-addressed hash table, which is mapped
+/// into memory.  It is keyed by canonical position, so a result proven in one
+/// run (or in one shard of a run) is found again in any later one.  Moves are
+/// kept in canonical coordinates, and depths are relative to the position.
+///
+/// Several processes may share one file: every lookup takes a shared lock on
+/// it, and every update an exclusive one.  When the table gets three-quarters
+/// full, or results are swept out, a new table is built in a file of its own
+/// beside the old and renamed over it, so that the old one is whole until the
+/// new one is, and anything that stops the work midway leaves it as it was.
+/// A process still holding the old file sees that it has no name any more
+/// when it next takes the lock, and opens the new one.  The file locks
+/// belong to the open file, not the thread, so threads of one process sharing
+/// the store also take a mutex.
+
+class solcache {
+public:
+    /// A single proven result.
+    struct solution {
+        unsigned long long xs;  ///< Key: cells of the 1st player.
+        unsigned long long os;  ///< Key: cells of the 2nd player.
+        int nodes;              ///< Positions searched to prove this.
+        signed char move;       ///< Canonical move to make, or -1 if there's no forced win.
+        unsigned char depth;    ///< Plays to the end of the sequence.
+        unsigned char flags;    ///< How it was found; nonzero for a slot in use.
+        unsigned char spare;    ///< Padding, for now.
+    };
+    static const unsigned char USED = 1;    ///< Flag for a slot in use.
+    static const unsigned char LEAVES = 2;  ///< Flag for strategic positions as leaves.
+
+    solcache();
+    ~solcache() {close(); pthread_mutex_destroy(&guard);}
+    bool open(const char *path);    //!< \brief Open (or create) the store.
+    void close();                   //!< \brief Release the store.
+    /// Look up a position.
+    bool find(const poskey &key, solution &result);
+    /// Record the result for a position.
+    void store(const poskey &key, int move, int depth, int nodes, int flags = 0);
+    /// Forget the results a test picks out; returns how many, or -1 if it can't.
+    long sweep(bool (*doomed)(const solution &s, void *arg), void *arg);
+    int hits;                       //!< Number of successful lookups.
+    int stores;                     //!< Number of results stored.
+private:
+    /// The beginning of the file.
+    struct header {
+        char magic[8];          ///< Identifies the file.
+        unsigned int slots;     ///< Size of the table; a power of 2.
+        unsigned int count;     ///< Slots in use.
+    };
+    static const unsigned int INITIAL = 1 << 16;    ///< Slots in a new table.
+    int fd;                 ///< The open file.
+    char *name;             ///< Its name, to find its replacement by.
+    pthread_mutex_t guard;  ///< Keeps the threads of this process out of each other's way.
+    header *map;            ///< Where it is mapped.
+    unsigned int slots;     ///< Size of the table as mapped.
+    solution *table() {return (solution *)(map + 1);}
+    bool remap();
+    bool current(int how);
+    solution *probe(const poskey &key);
+    static solution *place(solution *t, unsigned int n, const poskey &key);
+    long rebuild(unsigned int newslots, bool (*doomed)(const solution &s, void *arg), void *arg);
+    void grow();
+};
+
+#endif
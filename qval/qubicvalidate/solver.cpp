@@ -0,0 +1,287 @@
+/***************************************************************************
+                          solver.cpp  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Member functions of class solver.
+ */
+
+#include "solver.h"
+#include "proofgraph.h"
+#include "timer.h"
+
+unsigned long long solver::lines[76];
+
+solver::solver(phasereport *account) {
+    int c, i, w;
+
+    for (w=0; w<76; w++) lines[w] = 0;
+    for (c=0; c<64; c++) {
+        for (i=0; (w = win::through(c, i)) >= 0; i++) lines[w] |= 1ULL << c;
+    }
+    table = new entry[SLOTS];
+    for (i=0; i<SLOTS; i++) table[i].depth = 0;
+    oracle.account = account;
+    nodes = oracles = 0;
+    depth = 0;
+    deadline = 0;
+    timedout = false;
+}
+
+//************************************************************************** slot(const poskey &)
+/**
+ * The place in the table for a position.  What's there may be some other
+ * position, which the caller checks for and replaces.
+ * \param key the position, in canonical form.
+ * \return the entry.
+ */
+solver::entry &
+solver::slot(const poskey &key) {
+    return table[key.hash() & (SLOTS - 1)];
+}
+
+//************************************************************************** order(unsigned long long, unsigned long long, int *)
+/**
+ * List the empty cells, the best-looking first.  A cell scores as in
+ * ponderer::likely(): for every line through it the other player hasn't
+ * blocked, more for more of the mover's cells on it, and for every line it
+ * would block, more for more of the other player's.  So moves that win,
+ * block, or make threats come before the rest.
+ * \param mine the cells of the player to move.
+ * \param theirs the other player's cells.
+ * \param moves (output) the cells.
+ * \return how many there are.
+ */
+int
+solver::order(unsigned long long mine, unsigned long long theirs, int *moves) {
+    int scores[64];
+    int i, k, c, w, n = 0;
+
+    for (c=0; c<64; c++) {
+        if ((mine | theirs) >> c & 1) continue;
+        int s = 0;
+        for (i=0; (w = win::through(c, i)) >= 0; i++) {
+            int m = __builtin_popcountll(lines[w] & mine);
+            int t = __builtin_popcountll(lines[w] & theirs);
+            if (!t) s += 1 << (3 * m);
+            if (!m) s += 1 << (3 * t);
+        }
+        for (k=n++; k>0 && scores[k-1] < s; k--) {
+            scores[k] = scores[k-1];
+            moves[k] = moves[k-1];
+        }
+        scores[k] = s;
+        moves[k] = c;
+    }
+    return n;
+}
+
+//************************************************************************** canforce(unsigned long long, unsigned long long)
+/**
+ * Could the player to move start a force?  Only with a line holding two of
+ * the player's cells and none of the other's.
+ * \param mine the cells of the player to move.
+ * \param theirs the other player's cells.
+ * \return true if there's such a line.
+ */
+bool
+solver::canforce(unsigned long long mine, unsigned long long theirs) {
+    for (int w=0; w<76; w++) {
+        if (!(lines[w] & theirs) && __builtin_popcountll(lines[w] & mine) >= 2) return true;
+    }
+    return false;
+}
+
+//************************************************************************** forcing(unsigned long long, unsigned long long)
+/**
+ * Ask the forcing search whether the player to move wins.  The oracle's
+ * board has the player to move as its 1st player, whichever one that is.
+ * \param mine the cells of the player to move.
+ * \param theirs the other player's cells.
+ * \return true if a win was proven.
+ */
+bool
+solver::forcing(unsigned long long mine, unsigned long long theirs) {
+    poskey key;
+    bool proven;
+
+    key.xs = mine;
+    key.os = theirs;
+    oracle.setposition(key);
+    oracles++;
+    oracle.sequence(false, deadline, proven);
+    if (!proven && timer::now() >= deadline) timedout = true;
+    return proven;
+}
+
+//************************************************************************** search(unsigned long long, unsigned long long, int, int, int)
+/**
+ * The value of a position for the player to move, looking \a plies ahead.
+ * A forced block doesn't count as a ply.  Win and loss are proven whatever
+ * the window; neither is only known within the depth, and is kept in the
+ * table only if the window was the whole range.
+ * \param mine the cells of the player to move.
+ * \param theirs the other player's cells.
+ * \param plies how far to look.
+ * \param alpha the least value that matters.
+ * \param beta the value that's enough.
+ * \return WIN, LOSS or UNKNOWN.
+ */
+int
+solver::search(unsigned long long mine, unsigned long long theirs, int plies, int alpha, int beta) {
+    unsigned long long empty = ~(mine | theirs);
+    unsigned long long t;
+    poskey key;
+    int moves[64];
+    int i, n, v, best, next, from = alpha;
+
+    nodes++;
+    if (timedout || (nodes % board::CLOCKEVERY == 0 && timer::now() >= deadline)) {
+        timedout = true;
+        return UNKNOWN;
+    }
+    if (proofgraph::threats(mine, theirs) & empty) return WIN;
+    t = proofgraph::threats(theirs, mine) & empty;
+    if (t & (t - 1)) return LOSS;
+    if (!empty) return UNKNOWN;
+
+    // Near the edge the table costs more than it saves, except for the oracle.
+    bool leaf = !t && plies <= 0;
+    bool tabled = plies >= 2 || (leaf && canforce(mine, theirs));
+    if (tabled) {
+        if (__builtin_popcountll(mine) == __builtin_popcountll(theirs)) {
+            key.xs = mine;
+            key.os = theirs;
+        } else {
+            key.xs = theirs;
+            key.os = mine;
+        }
+        key = proofgraph::canonical(key);
+        entry &e = slot(key);
+        if (e.depth && e.key == key) {
+            if (e.depth == PROVEN) return e.val;
+            if (e.depth - 1 >= plies) return UNKNOWN;
+        }
+    }
+    if (leaf) {
+        if (!tabled) return UNKNOWN;
+        v = forcing(mine, theirs) ? WIN : UNKNOWN;
+        if (!timedout) {
+            entry &e = slot(key);
+            e.key = key;
+            e.val = v;
+            e.depth = (v == WIN) ? PROVEN : 1;
+        }
+        return v;
+    }
+
+    if (t) {
+        moves[0] = __builtin_ctzll(t);
+        n = 1;
+        next = plies;
+    } else {
+        n = order(mine, theirs, moves);
+        next = plies - 1;
+    }
+    best = LOSS;
+    for (i=0; i<n; i++) {
+        v = -search(theirs, mine | 1ULL << moves[i], next, -beta, -alpha);
+        if (v > best) best = v;
+        if (best > alpha) alpha = best;
+        if (alpha >= beta) break;
+    }
+
+    if (tabled && !timedout && (best != UNKNOWN || (from == LOSS && beta == WIN))) {
+        entry &e = slot(key);
+        e.key = key;
+        e.val = best;
+        // Depths are kept one up, so that 0 can mean empty.
+        e.depth = (best != UNKNOWN) ? PROVEN : plies + 1;
+    }
+    return best;
+}
+
+//************************************************************************** solve(board &, long long, value &)
+/**
+ * Find a move for the player to move, deepening the search until the value
+ * is proven, the whole game has been searched, or the time is up.  Moves
+ * proven to lose are dropped as they're found; when every move loses, the
+ * best-looking of those that held out longest is made, and when nothing is
+ * proven, the best-looking one that's left.
+ * \param b the board, with the position on it; it's only looked at.
+ * \param until when to give up, or 0 for PATIENCE from now.
+ * \param result (output) what the player to move can expect.
+ * \return the move, or -1 if the board is full.
+ */
+int
+solver::solve(board &b, long long until, value &result) {
+    unsigned long long xs = 0, os = 0, mine, theirs, empty, t;
+    int moves[64];
+    int i, k, n, v, plies, empties;
+
+    for (i=0; i<64; i++) {
+        if (b.val(i) == point::X) xs |= 1ULL << i;
+        if (b.val(i) == point::O) os |= 1ULL << i;
+    }
+    if (__builtin_popcountll(xs) == __builtin_popcountll(os)) {
+        mine = xs;
+        theirs = os;
+    } else {
+        mine = os;
+        theirs = xs;
+    }
+    nodes = oracles = 0;
+    depth = 0;
+    timedout = false;
+    deadline = until ? until : timer::now() + PATIENCE;
+    result = UNKNOWN;
+
+    empty = ~(mine | theirs);
+    empties = __builtin_popcountll(empty);
+    if ((t = proofgraph::threats(mine, theirs) & empty)) {
+        result = WIN;
+        return __builtin_ctzll(t);
+    }
+    if ((t = proofgraph::threats(theirs, mine) & empty)) {
+        // Block; and if there's more than one, it's no use.
+        if (t & (t - 1)) result = LOSS;
+        moves[0] = __builtin_ctzll(t);
+        n = 1;
+    } else {
+        n = order(mine, theirs, moves);
+    }
+    if (n == 0) return -1;
+    if (result == LOSS) return moves[0];
+
+    for (plies=0; plies<empties && !timedout; plies++) {
+        for (i=k=0; i<n; i++) {
+            v = -search(theirs, mine | 1ULL << moves[i], plies, LOSS, WIN);
+            if (v == WIN) {
+                result = WIN;
+                depth = plies + 1;
+                return moves[i];
+            }
+            // A loss is proven even if the time ran out.
+            if (v != LOSS) moves[k++] = moves[i];
+        }
+        if (k == 0) {
+            result = LOSS;
+            return moves[0];
+        }
+        n = k;
+        if (!timedout) depth = plies + 1;
+    }
+    return moves[0];
+}
@@ -0,0 +1,83 @@
+/***************************************************************************
+                          solver.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class solver.
+ */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "qval.h"
+#include "poskey.h"
+#include "board.h"
+#include "phasereport.h"
+
+/// Searches the whole game from any position, for whichever player is to move.
+
+/// The dictionary and the forcing search only know how the 1st player wins
+/// from positions that come of Patashnik's strategy.  The solver takes any
+/// position, and either player.  It is an alpha-beta search of the moves of
+/// both sides, with three values: the player to move wins, loses, or neither
+/// is proven.  Threats cut it down: a player who can win does; one who must
+/// block has only the block; and one facing two threats at once has lost.
+///
+/// At the edge of the search, a position where the player to move could
+/// start a force is handed to board::sequence(), with the colours swapped if
+/// it's the 2nd player.  A win it proves is a win at that node.
+///
+/// The search is deepened a ply at a time until a value is proven, there is
+/// nothing left to search, or the time is up.  Positions are kept in a table
+/// by their canonical form: proven ones for good, the rest with the depth
+/// they were searched to.  When nothing is proven, the move is the one that
+/// looks best and isn't known to lose.
+
+class solver {
+public:
+    /// What the player to move can expect.
+    enum value {LOSS = -1, UNKNOWN = 0, WIN = 1};
+
+    solver(phasereport *account = &report);
+    ~solver() {delete[] table;}
+    /// Find a move for whichever player is to move on \a b, by \a until (0 for PATIENCE from now).
+    int solve(board &b, long long until, value &result);
+    static const int SLOTS = 1 << 18;   ///< Entries in the table; a power of 2.
+    static const long long PATIENCE = 10000000000LL;    ///< Nanoseconds to try without a limit.
+    long long nodes;        ///< Positions looked at by the last solve().
+    long long oracles;      ///< How many of them went to the forcing search.
+    int depth;              ///< Plies the last solve() searched to.
+private:
+    /// A position in the table.
+    struct entry {
+        poskey key;             ///< Canonical.
+        signed char val;        ///< For the player to move.
+        unsigned char depth;    ///< Plies searched, or PROVEN.
+    };
+    static const unsigned char PROVEN = 255;
+    entry *table;
+    board oracle;           ///< Where the forcing search is done.
+    long long deadline;
+    bool timedout;
+    static unsigned long long lines[76];    ///< The cells of each win.
+
+    int search(unsigned long long mine, unsigned long long theirs, int plies, int alpha, int beta);
+    int order(unsigned long long mine, unsigned long long theirs, int *moves);
+    bool canforce(unsigned long long mine, unsigned long long theirs);
+    bool forcing(unsigned long long mine, unsigned long long theirs);
+    entry &slot(const poskey &key);
+};
+
+#endif
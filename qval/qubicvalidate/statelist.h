@@ -29,6 +29,7 @@
 class statelist {
 private:
     state states[state::cardinality];
+    winset sets[state::cardinality];    ///< The same lists, as sets of wins.
 public:
     /// Constructor to make an initialized list.
     statelist();
@@ -44,14 +45,23 @@ public:
     bool canforce() {return !states[state::X2].isempty();}
     /// Determine if a move is forcing.
     int canForceAt(int *where);
-    /// Record the state of a line.
-    void makeme(int me, line *l) {
+    /// The lines where I have two points, and could force.
+    const winset &xtwos() {return sets[state::X2];}
+    /// The lines where I have just one point.
+    const winset &xones() {return sets[state::X1];}
+    /// The lines where the opponent has two points, and could force.
+    const winset &otwos() {return sets[state::O2];}
+    /// Record the new state of a line that was in state \a was.
+    void makeme(int was, int me, line *l) {
+        sets[was].drop(l->self());
+        sets[me].add(l->self());
         states[me].add(l);
     }
     /// Enhance the display of any winning line.
     void highlight();
     /// Add a line to a state.
     void add(line *what, state::statenum as) {
+        sets[as].add(what->self());
         states[as].add(what);
     }
     /// Dump the member lines of a state.
@@ -92,6 +92,7 @@ there are 2929 lines and 52040 characters total.
 #include "qval.h"
 #include "strategic.h"
 #include "point.h"
+#include "win.h"
 
 int
 strategic::i=0;
@@ -99,6 +100,12 @@ strategic::i=0;
 strategic
 strategic::smv[2929];
 
+short
+strategic::slot[8192];
+
+unsigned int
+strategic::bloom[1024];
+
 // Read the pattern to make a board.  Fill in the 'strategic' object.
 void
 strategic::makeNext(const char *pattern, int mt) {
@@ -144,10 +151,52 @@ strategic::makeNext(const char *pattern, int mt) {
 		}
 		cursor++;
 	}
+	for (int i=0; i<64; i++) {
+		if (sp->points[i] == point::X) sp->key.xs |= 1ULL << i;
+		if (sp->points[i] == point::O) sp->key.os |= 1ULL << i;
+	}
+}
+
+// Index all the strategic moves by position, and put their census in the
+// filter.  The census adds up the contribution of every line, so it comes
+// out the same no matter how the lines are numbered.
+void
+strategic::makeIndex() {
+	for (int n=0; n<i; n++) {
+		int k = smv[n].key.hash() & 8191;
+		while (slot[k]) k = (k + 1) & 8191;
+		slot[k] = n + 1;
+
+		unsigned long long census = 0;
+		for (int l=0; l<win::count(); l++) {
+			int xs = 0, os = 0;
+			for (int c=0; c<4; c++) {
+				int v = smv[n].points[win::find(l).val(c)];
+				if (v == point::X) xs++;
+				if (v == point::O) os++;
+			}
+			census += linemix(xs, os);
+		}
+		bloom[(census >> 5) & 1023] |= 1U << (census & 31);
+		bloom[(census >> 25) & 1023] |= 1U << ((census >> 20) & 31);
+		bloom[(census >> 45) & 1023] |= 1U << ((census >> 40) & 31);
+	}
+}
+
+// Find the strategic move for a canonical position, or -1 if there's none.
+int
+strategic::lookup(const poskey &key) {
+	int k = key.hash() & 8191;
+	while (slot[k]) {
+		if (smv[slot[k]-1].key == key) return slot[k] - 1;
+		k = (k + 1) & 8191;
+	}
+	return -1;
 }
 
 void
 strategic::init() {
+	if (i > 0) return;	// already done
 	makeNext("", 0);
 	makeNext("x14o", 12);
 #ifdef DOXYGEN_SHOULD_SKIP_THIS
@@ -3080,5 +3129,6 @@ strategic::init() {
 	makeNext("xxox3o7x5o9o9o18xo1x", 48);
 	makeNext("xxox3o7x5oxo17o19o1x", 51);
 	makeNext("xxox8x2o5o19o", 48);
+	makeIndex();
 #endif
 }
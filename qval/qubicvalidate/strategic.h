@@ -21,22 +21,51 @@
 #ifndef STRATEGIC_H
 #define STRATEGIC_H
 
+#include "poskey.h"
+
 /// A "strategic" position in the strategy, and corresponding chosen play.
+
+/// Besides the array of all of them, there are two ways to find one
+/// quickly.  A hashed index finds the entry for a canonical position.  Before
+/// going to the trouble of making a position canonical, a Bloom filter can
+/// be asked if it might be in the dictionary at all.  The filter is keyed by
+/// the census of the position, which is the same under every isomorphism.
 class strategic {
     friend class board;
 private:
     static int i;   ///< The count of strategic moves.
     static void makeNext(const char *pattern, int mt);    ///< Add one to the collection.
+    static void makeIndex();    ///< Build the index and the filter.
     static strategic smv[2929]; ///< The array of all strategic moves.
+    static short slot[8192];    ///< The hashed index: entry number plus one.
+    static unsigned int bloom[1024];    ///< The filter: 32768 bits.
 public:
     movenum points[64];     ///< The canonic board for this position
     movenum moveto;         ///< Where the 1st player can win
     const char *pattern;          ///< The text representation of this position.
+    poskey key;             ///< The canonic board, packed.
     static void init();     ///< Initialize.
+    /// The number of strategic moves.
+    static int count() {return i;}
     /// For validation -- produce the indexed strategic object.
     static strategic &find(int i) {
         return smv[i];
     }
+    /// Find the entry for a canonical position.
+    static int lookup(const poskey &key);
+    /// Is a position with this census possibly in the dictionary?
+    static bool maybe(unsigned long long census) {
+        return (bloom[(census >> 5) & 1023] & (1U << (census & 31)))
+            && (bloom[(census >> 25) & 1023] & (1U << ((census >> 20) & 31)))
+            && (bloom[(census >> 45) & 1023] & (1U << ((census >> 40) & 31)));
+    }
+    /// The contribution of a line with \a xs exs and \a os ohs to a census.
+    static unsigned long long linemix(int xs, int os) {
+        unsigned long long h = (xs * 5 + os + 1) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 29;
+        h *= 0xBF58476D1CE4E5B9ULL;
+        return h ^ (h >> 32);
+    }
 };
 
 #endif
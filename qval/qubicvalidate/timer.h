@@ -0,0 +1,46 @@
+/***************************************************************************
+                          timer.h  -  description
+                             -------------------
+    begin                : Mon Oct 19 2026
+    copyright            : (C) 2026 by Kevin O'Gorman
+    email                : kogorman@kosmanor.com
+ ***************************************************************************/
+
+/***************************************************************************
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License v2, as published *
+ *   by the Free Software Foundation.                                      *
+ *                                                                         *
+ ***************************************************************************/
+
+/*! \file
+ * \brief Declaration of class timer.
+ */
+
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <time.h>
+
+/// A stopwatch, reading the monotonic clock in nanoseconds.
+
+class timer {
+private:
+    long long started;      ///< When the watch was last reset.
+public:
+    /// The time now, in nanoseconds since some fixed moment.
+    static long long now() {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    }
+    /// Construct a running stopwatch.
+    timer() {reset();}
+    /// Start timing again from zero.
+    void reset() {started = now();}
+    /// Nanoseconds since the last reset.
+    long long elapsed() const {return now() - started;}
+};
+
+#endif
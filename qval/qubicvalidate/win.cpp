@@ -24,6 +24,9 @@
 
 int win::nextwin;
 win win::wins[100];
+int win::thru[64][8];
+winset win::cells[64];
+signed char win::cross[76][76];
 
 /// Prints all of the collected wins.
 void
@@ -60,6 +63,7 @@ win::init() {
 	win body(16,17,18,19);			// flat without cutting a major diagonal
 	win diag(0,5,10,15);			// "minor" diagonal.  All cut 2 majors.
 
+	if (nextwin > 0) return;		// already done
 	nextwin = 0;
 
 	for (int i=0; i<iso::nextiso; i++) {
@@ -68,6 +72,30 @@ win::init() {
 		win::add(iso::isos[i] * diag);
 		win::add(iso::isos[i] * body);
 	}
+
+	// Note the wins through each point.
+	for (int c=0; c<64; c++) {
+		int n = 0;
+		for (int w=0; w<nextwin; w++) {
+			if (wins[w].has(c)) {
+				thru[c][n++] = w;
+				cells[c].add(w);
+			}
+		}
+		thru[c][n] = -1;
+	}
+
+	// Note where each pair of wins meets.  Two lines never share more
+	// than one point.
+	for (int a=0; a<nextwin; a++) {
+		for (int b=0; b<nextwin; b++) {
+			cross[a][b] = -1;
+			if (a == b) continue;
+			for (int k=0; k<4; k++) {
+				if (wins[b].has(wins[a].index[k])) cross[a][b] = wins[a].index[k];
+			}
+		}
+	}
 #ifndef NDEBUG
 	cout << "There are " << nextwin << " winning lines" << endl;
 #endif
@@ -23,6 +23,62 @@
 
 #include "iso.h"
 
+/// A set of wins, with one bit for each of them.
+
+/// Sets like this make it quick to ask how lines cross: for instance, a point
+/// lying on two lines where I have two points is a fork.
+
+class winset {
+public:
+    unsigned long long lo;      ///< Wins 0 through 63.
+    unsigned long long hi;      ///< Wins 64 and up.
+    /// Construct the empty set.
+    winset(): lo(0), hi(0) {}
+    /// Add a win to the set.
+    void add(int w) {
+        if (w < 64) lo |= 1ULL << w; else hi |= 1ULL << (w - 64);
+    }
+    /// Drop a win from the set.
+    void drop(int w) {
+        if (w < 64) lo &= ~(1ULL << w); else hi &= ~(1ULL << (w - 64));
+    }
+    /// Is the win in the set?
+    bool has(int w) const {
+        return (w < 64) ? (lo >> w) & 1 : (hi >> (w - 64)) & 1;
+    }
+    /// Is the set empty?
+    bool empty() const {return !(lo | hi);}
+    /// How many wins in the set.
+    int count() const {return __builtin_popcountll(lo) + __builtin_popcountll(hi);}
+    /// The lowest-numbered win in the set, or -1 if it's empty.
+    int first() const {
+        if (lo) return __builtin_ctzll(lo);
+        if (hi) return 64 + __builtin_ctzll(hi);
+        return -1;
+    }
+    /// Intersection.
+    winset operator&(const winset& other) const {
+        winset r;
+        r.lo = lo & other.lo;
+        r.hi = hi & other.hi;
+        return r;
+    }
+    /// Union.
+    winset operator|(const winset& other) const {
+        winset r;
+        r.lo = lo | other.lo;
+        r.hi = hi | other.hi;
+        return r;
+    }
+    /// Difference.
+    winset operator-(const winset& other) const {
+        winset r;
+        r.lo = lo & ~other.lo;
+        r.hi = hi & ~other.hi;
+        return r;
+    }
+};
+
 /// An abstraction for a line that wins the game.
 
 /// A "win" is an abstraction for a winning line.  It is represented
@@ -40,9 +96,32 @@ private:
     int index[4];               ///< The indexes of the 4 points.
     static int nextwin;         ///< The number of distinct wins seen so far.
     static win wins[100];       ///< The collection of all wins.
+    static int thru[64][8];     ///< The wins through each point, ending with -1.
+    static winset cells[64];    ///< The wins through each point, as a set.
+    static signed char cross[76][76];   ///< Where two wins meet, or -1.
 public:
     /// Return the number of wins collected.
     static int count(){return nextwin;}
+    /// Produce the indexed win.
+    static win &find(int i) {return wins[i];}
+    /// The \a i'th win through point \a cell, or -1 when there are no more.
+    static int through(int cell, int i) {return thru[cell][i];}
+    /// The set of wins through point \a cell.
+    static const winset &at(int cell) {return cells[cell];}
+    /// The point where wins \a a and \a b meet, or -1 if they don't.
+    static int meet(int a, int b) {return cross[a][b];}
+    /// The win through both points, if there is one, or else -1.
+    static int joining(int a, int b) {
+        int w;
+        for (int i=0; (w = thru[a][i]) >= 0; i++) {
+            if (wins[w].has(b)) return w;
+        }
+        return -1;
+    }
+    /// Is point \a cell in this win?
+    bool has(int cell) {
+        return index[0]==cell || index[1]==cell || index[2]==cell || index[3]==cell;
+    }
     /// Set up the collection of wins.
     static void init();
     /// Construct a win: the first prototype.